@@ -1,6 +1,9 @@
 #include "meld/app/run.hpp"
 #include "meld/app/version.hpp"
 #include "meld/concurrency.hpp"
+#include "meld/core/message.hpp"
+#include "meld/utilities/execution_statistics.hpp"
+#include "meld/utilities/tracer.hpp"
 
 #include "boost/program_options.hpp"
 #include "libjsonnet++.h"
@@ -34,7 +37,14 @@ int main(int argc, char* argv[])
        "Maximum parallelism requested for the program")
     ("version", ("Print meld version ("s + meld::version() + ")").c_str())
     ("dot-file,g",
-       bpo::value<std::string>(), "Produce DOT file representing graph of framework nodes");
+       bpo::value<std::string>(), "Produce DOT file representing graph of framework nodes")
+    ("trace",
+       bpo::value<std::string>(),
+       "Record framework trace events and write them to the specified file (Chrome trace-event format)")
+    ("oldest-first",
+       "Process the messages waiting for a node in the order in which they were read from the source")
+    ("statistics",
+       "Time the executions of each node and report the statistics at the end of the job");
   // clang-format on
 
   // Parse the command line.
@@ -79,6 +89,16 @@ int main(int argc, char* argv[])
     dot_file = make_optional(std::move(filename));
   }
 
+  std::optional<std::string> trace_file{};
+  if (vm.count("trace")) {
+    auto filename = vm["trace"].as<std::string>();
+    if (std::empty(filename)) {
+      std::cerr << "Error: The 'trace' option cannot use an empty filename.\n";
+      return 3;
+    }
+    trace_file = make_optional(std::move(filename));
+  }
+
   jsonnet::Jsonnet j;
   if (not j.init()) {
     std::cerr << "Error: Could not initialize Jsonnet parser.\n";
@@ -105,5 +125,18 @@ int main(int argc, char* argv[])
   if (not vm["parallel"].defaulted()) {
     max_concurrency = vm["parallel"].as<int>();
   }
+
+  if (trace_file) {
+    meld::trace::enable();
+  }
+  if (vm.count("oldest-first")) {
+    meld::enable_oldest_first();
+  }
+  if (vm.count("statistics")) {
+    meld::enable_execution_statistics();
+  }
   meld::run(configurations, std::move(dot_file), max_concurrency);
+  if (trace_file) {
+    meld::trace::write_chrome_trace(*trace_file);
+  }
 }
@@ -10,7 +10,20 @@ namespace meld {
            std::optional<std::string> dot_file,
            int const max_parallelism)
   {
-    framework_graph g{load_source(configurations.at("source").as_object()), max_parallelism};
+    in_flight_limits max_in_flight;
+    if (auto const* limits = configurations.if_contains("max_in_flight")) {
+      for (auto const& [level_name, max] : limits->as_object()) {
+        max_in_flight.try_emplace(std::string(level_name), max.to_number<std::size_t>());
+      }
+    }
+
+    framework_graph g{
+      load_source(configurations.at("source").as_object()), max_parallelism, max_in_flight};
+    if (auto const* resources = configurations.if_contains("resources")) {
+      for (auto const& [name, tokens] : resources->as_object()) {
+        g.declare_resource(std::string(name), tokens.to_number<std::size_t>());
+      }
+    }
     auto const module_configs = configurations.at("modules").as_object();
     for (auto const& [key, value] : module_configs) {
       load_module(g, key, value.as_object());
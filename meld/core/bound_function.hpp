@@ -10,6 +10,7 @@
 #include "meld/core/declared_transform.hpp"
 #include "meld/core/node_catalog.hpp"
 #include "meld/core/node_options.hpp"
+#include "meld/core/replicas.hpp"
 #include "meld/metaprogramming/delegate.hpp"
 #include "meld/metaprogramming/type_deduction.hpp"
 #include "meld/model/qualified_name.hpp"
@@ -35,10 +36,12 @@ namespace meld {
                    concurrency c,
                    tbb::flow::graph& g,
                    node_catalog& nodes,
-                   std::vector<std::string>& errors) :
+                   std::vector<std::string>& errors,
+                   std::shared_ptr<replicas<T>> obj_replicas = nullptr) :
       node_options_t{config},
       name_{config ? config->get<std::string>("module_label") : "", std::move(name)},
       obj_{obj},
+      replicas_{std::move(obj_replicas)},
       ft_{std::move(f)},
       concurrency_{c},
       graph_{g},
@@ -56,8 +59,9 @@ namespace meld {
                            std::move(name_),
                            concurrency_.value,
                            node_options_t::release_predicates(),
+                           resources(),
                            graph_,
-                           delegate(obj_, ft_),
+                           bound_delegate(),
                            std::move(inputs)};
     }
 
@@ -70,8 +74,9 @@ namespace meld {
                          std::move(name_),
                          concurrency_.value,
                          node_options_t::release_predicates(),
+                         resources(),
                          graph_,
-                         delegate(obj_, ft_),
+                         bound_delegate(),
                          std::move(inputs)};
     }
 
@@ -84,8 +89,9 @@ namespace meld {
                            std::move(name_),
                            concurrency_.value,
                            node_options_t::release_predicates(),
+                           resources(),
                            graph_,
-                           delegate(obj_, ft_),
+                           bound_delegate(),
                            std::move(inputs)};
     }
 
@@ -98,8 +104,9 @@ namespace meld {
                            std::move(name_),
                            concurrency_.value,
                            node_options_t::release_predicates(),
+                           resources(),
                            graph_,
-                           delegate(obj_, ft_),
+                           bound_delegate(),
                            std::move(inputs)};
     }
 
@@ -160,8 +167,31 @@ namespace meld {
     }
 
   private:
+    // Each node registered for a replicated object uses the replicas' resource.
+    serializer_nodes resources()
+    {
+      auto names = node_options_t::release_resources();
+      if constexpr (not std::same_as<T, void_tag>) {
+        if (replicas_) {
+          names.push_back(replicas_->resource_name());
+        }
+      }
+      return nodes_.serializers_.get(std::move(names));
+    }
+
+    auto bound_delegate()
+    {
+      if constexpr (not std::same_as<T, void_tag>) {
+        if (replicas_) {
+          return delegate(replicas_, ft_);
+        }
+      }
+      return delegate(obj_, ft_);
+    }
+
     qualified_name name_;
     std::shared_ptr<T> obj_;
+    std::shared_ptr<replicas<T>> replicas_;
     FT ft_;
     concurrency concurrency_;
     tbb::flow::graph& graph_;
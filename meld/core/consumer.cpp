@@ -1,15 +1,28 @@
 #include "meld/core/consumer.hpp"
 
 namespace meld {
-  consumer::consumer(qualified_name name, std::vector<std::string> predicates) :
-    name_{std::move(name)}, predicates_{std::move(predicates)}
+  consumer::consumer(qualified_name name,
+                     std::vector<std::string> predicates,
+                     serializer_nodes resources) :
+    name_{std::move(name)},
+    full_name_{name_.full()},
+    predicates_{std::move(predicates)},
+    resources_{std::move(resources)},
+    trace_name_{trace::register_name(full_name_)}
   {
   }
 
-  std::string consumer::full_name() const { return name_.full(); }
+  std::string const& consumer::full_name() const noexcept { return full_name_; }
 
   std::string const& consumer::module() const noexcept { return name_.module(); }
   std::string const& consumer::name() const noexcept { return name_.name(); }
 
   std::vector<std::string> const& consumer::when() const noexcept { return predicates_; }
+  serializer_nodes const& consumer::resources() const noexcept { return resources_; }
+
+  execution_summary consumer::statistics() const { return statistics_.summary(); }
+  auto consumer::time_call() noexcept -> call_sentry
+  {
+    return {statistics_.time(), {trace::category::node, trace_name_}};
+  }
 }
@@ -1,7 +1,10 @@
 #ifndef meld_core_consumer_hpp
 #define meld_core_consumer_hpp
 
+#include "meld/graph/serializer_node.hpp"
 #include "meld/model/qualified_name.hpp"
+#include "meld/utilities/execution_statistics.hpp"
+#include "meld/utilities/tracer.hpp"
 
 #include <string>
 #include <vector>
@@ -9,16 +12,54 @@
 namespace meld {
   class consumer {
   public:
-    consumer(qualified_name name, std::vector<std::string> predicates);
+    consumer(qualified_name name,
+             std::vector<std::string> predicates,
+             serializer_nodes resources = {});
 
-    std::string full_name() const;
+    std::string const& full_name() const noexcept;
     std::string const& module() const noexcept;
     std::string const& name() const noexcept;
     std::vector<std::string> const& when() const noexcept;
+    serializer_nodes const& resources() const noexcept;
+    execution_summary statistics() const;
+
+  protected:
+    // Times (and traces) an invocation of the user function for the lifetime of the
+    // returned object.
+    struct call_sentry {
+      execution_statistics::sentry timer;
+      trace::scope trace;
+    };
+    call_sentry time_call() noexcept;
+
+    // The tokens of the node's resources have been acquired before the node's body is
+    // invoked.  They are returned when the object below is destroyed, which must happen
+    // for each invocation of the body.
+    class resource_sentry {
+    public:
+      explicit resource_sentry(serializer_nodes const& resources) noexcept :
+        resources_{resources}
+      {
+      }
+      ~resource_sentry()
+      {
+        for (auto* resource : resources_) {
+          resource->try_put(1);
+        }
+      }
+
+    private:
+      serializer_nodes const& resources_;
+    };
+    resource_sentry hold_resources() const noexcept { return resource_sentry{resources_}; }
 
   private:
     qualified_name name_;
+    std::string full_name_; // Referred to by the stores the node creates (see source())
     std::vector<std::string> predicates_;
+    serializer_nodes resources_;
+    execution_statistics statistics_;
+    trace::name_t trace_name_;
   };
 }
 
@@ -1,8 +1,10 @@
 #include "meld/core/declared_monitor.hpp"
 
 namespace meld {
-  declared_monitor::declared_monitor(qualified_name name, std::vector<std::string> predicates) :
-    products_consumer{std::move(name), std::move(predicates)}
+  declared_monitor::declared_monitor(qualified_name name,
+                                     std::vector<std::string> predicates,
+                                     serializer_nodes resources) :
+    products_consumer{std::move(name), std::move(predicates), std::move(resources)}
   {
   }
 
@@ -38,7 +38,9 @@ namespace meld {
 
   class declared_monitor : public products_consumer {
   public:
-    declared_monitor(qualified_name name, std::vector<std::string> predicates);
+    declared_monitor(qualified_name name,
+                     std::vector<std::string> predicates,
+                     serializer_nodes resources);
     virtual ~declared_monitor();
   };
 
@@ -58,12 +60,14 @@ namespace meld {
                 qualified_name name,
                 std::size_t concurrency,
                 std::vector<std::string> predicates,
+                serializer_nodes resources,
                 tbb::flow::graph& g,
                 function_t&& f,
                 InputArgs input_args) :
       name_{std::move(name)},
       concurrency_{concurrency},
       predicates_{std::move(predicates)},
+      resources_{std::move(resources)},
       graph_{g},
       ft_{std::move(f)},
       input_args_{std::move(input_args)},
@@ -89,6 +93,7 @@ namespace meld {
       return std::make_unique<complete_monitor>(std::move(name_),
                                                 concurrency_,
                                                 std::move(predicates_),
+                                                std::move(resources_),
                                                 graph_,
                                                 std::move(ft_),
                                                 std::move(input_args_),
@@ -97,6 +102,7 @@ namespace meld {
     qualified_name name_;
     std::size_t concurrency_;
     std::vector<std::string> predicates_;
+    serializer_nodes resources_;
     tbb::flow::graph& graph_;
     function_t ft_;
     InputArgs input_args_;
@@ -118,11 +124,12 @@ namespace meld {
     complete_monitor(qualified_name name,
                      std::size_t concurrency,
                      std::vector<std::string> predicates,
+                     serializer_nodes resources,
                      tbb::flow::graph& g,
                      function_t&& f,
                      InputArgs input,
                      std::array<specified_label, N> product_labels) :
-      declared_monitor{std::move(name), std::move(predicates)},
+      declared_monitor{std::move(name), std::move(predicates), std::move(resources)},
       product_labels_{std::move(product_labels)},
       input_{std::move(input)},
       join_{make_join_or_none(g, std::make_index_sequence<N>{})},
@@ -130,6 +137,7 @@ namespace meld {
                concurrency,
                [this, ft = std::move(f)](
                  messages_t<N> const& messages) -> oneapi::tbb::flow::continue_msg {
+                 auto const tokens = hold_resources();
                  auto const& msg = most_derived(messages);
                  auto const& [store, message_id] = std::tie(msg.store, msg.id);
                  if (store->is_flush()) {
@@ -137,6 +145,7 @@ namespace meld {
                  }
                  else if (accessor a; needs_new(store, a)) {
                    call(ft, messages, std::make_index_sequence<N>{});
+                   finished_with_inputs(input_, messages);
                    a->second = true;
                    flag_for(store->id()->hash()).mark_as_processed();
                  }
@@ -145,9 +154,9 @@ namespace meld {
                    stores_.erase(store->id()->hash());
                  }
                  return {};
-               }}
+               }},
+      edge_{g, concurrency, join_, monitor_, this->resources()}
     {
-      make_edge(join_, monitor_);
     }
 
     ~complete_monitor()
@@ -167,8 +176,17 @@ namespace meld {
     }
 
     std::vector<tbb::flow::receiver<message>*> ports() override { return input_ports<N>(join_); }
+    void try_put_all(message const& msg, std::span<std::size_t const> depths) override
+    {
+      edge_.try_put_all(msg, depths);
+    }
 
     specified_labels input() const override { return product_labels_; }
+    void set_consumer_count(specified_label const& product_label,
+                            std::size_t const count) override
+    {
+      meld::set_consumer_count(input_, product_label, count);
+    }
 
     bool needs_new(product_store_const_ptr const& store, accessor& a)
     {
@@ -182,6 +200,7 @@ namespace meld {
     void call(function_t const& ft, messages_t<N> const& messages, std::index_sequence<Is...>)
     {
       ++calls_;
+      auto const sentry = time_call();
       return std::invoke(ft, std::get<Is>(input_).retrieve(messages)...);
     }
 
@@ -190,7 +209,8 @@ namespace meld {
     std::array<specified_label, N> product_labels_;
     InputArgs input_;
     join_or_none_t<N> join_;
-    tbb::flow::function_node<messages_t<N>> monitor_;
+    tbb::flow::function_node<messages_t<N>, tbb::flow::continue_msg, tbb::flow::rejecting> monitor_;
+    ordered_edge<N> edge_;
     tbb::concurrent_hash_map<level_id::hash_type, bool> stores_;
     std::atomic<std::size_t> calls_;
   };
@@ -4,17 +4,52 @@ namespace meld {
   declared_output::declared_output(qualified_name name,
                                    std::size_t concurrency,
                                    std::vector<std::string> predicates,
+                                   serializer_nodes resources,
                                    tbb::flow::graph& g,
                                    detail::output_function_t&& ft) :
-    consumer{std::move(name), std::move(predicates)},
-    node_{g, concurrency, [f = std::move(ft)](message const& msg) -> tbb::flow::continue_msg {
+    consumer{std::move(name), std::move(predicates), std::move(resources)},
+    node_{g, concurrency, [this, f = std::move(ft)](message const& msg) -> tbb::flow::continue_msg {
+            auto const tokens = hold_resources();
             if (not msg.store->is_flush()) {
+              auto const sentry = time_call();
               f(*msg.store);
+              finished_with(*msg.store);
             }
             return {};
           }}
   {
+    if (empty(this->resources())) {
+      return;
+    }
+
+    // The resources' tokens can be acquired only by messages held in a buffering node.
+    queue_ = std::make_unique<tbb::flow::queue_node<message>>(g);
+    chain_ = std::make_unique<resource_chain<message>>(g, *queue_, this->resources(), node_);
   }
 
-  tbb::flow::receiver<message>& declared_output::port() noexcept { return node_; }
+  tbb::flow::receiver<message>& declared_output::port() noexcept
+  {
+    if (queue_) {
+      return *queue_;
+    }
+    return node_;
+  }
+
+  void declared_output::set_consumer_counts(
+    std::map<std::string, std::vector<std::string>> const& consumers,
+    std::size_t const num_outputs)
+  {
+    num_outputs_ = num_outputs;
+    for (auto const& [product_name, nodes] : consumers) {
+      consumer_counts_[product_id{product_name}.index()] = size(nodes) + num_outputs;
+    }
+  }
+
+  void declared_output::finished_with(product_store const& store) const
+  {
+    for (auto const& [id, _] : store) {
+      auto it = consumer_counts_.find(id.index());
+      store.finished_with(id, it != consumer_counts_.end() ? it->second : num_outputs_);
+    }
+  }
 }
@@ -7,6 +7,7 @@
 #include "meld/core/message.hpp"
 #include "meld/core/node_options.hpp"
 #include "meld/core/registrar.hpp"
+#include "meld/core/resource_chain.hpp"
 #include "meld/model/level_id.hpp"
 #include "meld/model/product_store.hpp"
 #include "meld/model/qualified_name.hpp"
@@ -19,7 +20,9 @@
 #include <memory>
 #include <string>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace meld {
   namespace detail {
@@ -30,13 +33,25 @@ namespace meld {
     declared_output(qualified_name name,
                     std::size_t concurrency,
                     std::vector<std::string> predicates,
+                    serializer_nodes resources,
                     tbb::flow::graph& g,
                     detail::output_function_t&& ft);
 
     tbb::flow::receiver<message>& port() noexcept;
 
+    // Called when the graph is finalized with the nodes that consume each product, and
+    // with the number of output nodes (each of which sees all products).
+    void set_consumer_counts(std::map<std::string, std::vector<std::string>> const& consumers,
+                             std::size_t num_outputs);
+
   private:
+    void finished_with(product_store const& store) const;
+
     tbb::flow::function_node<message> node_;
+    std::unique_ptr<tbb::flow::queue_node<message>> queue_;
+    std::unique_ptr<resource_chain<message>> chain_;
+    std::unordered_map<std::size_t, std::size_t> consumer_counts_; // Keyed by product ID index
+    std::size_t num_outputs_{};
   };
 
   using declared_output_ptr = std::unique_ptr<declared_output>;
@@ -50,13 +65,17 @@ namespace meld {
                    configuration const* config,
                    std::string name,
                    tbb::flow::graph& g,
+                   serializers& resources,
                    detail::output_function_t&& f,
-                   concurrency c) :
+                   concurrency c,
+                   std::vector<std::string> required_resources = {}) :
       node_options_t{config},
       name_{config ? config->get<std::string>("module_label") : "", std::move(name)},
       graph_{g},
+      resources_{resources},
       ft_{std::move(f)},
       concurrency_{c},
+      required_resources_{std::move(required_resources)},
       reg_{std::move(reg)}
     {
       reg_.set([this] { return create(); });
@@ -65,17 +84,23 @@ namespace meld {
   private:
     declared_output_ptr create()
     {
+      auto resource_names = node_options_t::release_resources();
+      resource_names.insert(
+        resource_names.end(), begin(required_resources_), end(required_resources_));
       return std::make_unique<declared_output>(std::move(name_),
                                                concurrency_.value,
                                                node_options_t::release_predicates(),
+                                               resources_.get(std::move(resource_names)),
                                                graph_,
                                                std::move(ft_));
     }
 
     qualified_name name_;
     tbb::flow::graph& graph_;
+    serializers& resources_;
     detail::output_function_t ft_;
     concurrency concurrency_;
+    std::vector<std::string> required_resources_; // E.g. the resource of replicated objects
     registrar<declared_outputs> reg_;
   };
 }
@@ -1,10 +1,16 @@
 #include "meld/core/declared_predicate.hpp"
 
 namespace meld {
-  declared_predicate::declared_predicate(qualified_name name, std::vector<std::string> predicates) :
-    products_consumer{std::move(name), std::move(predicates)}
+  declared_predicate::declared_predicate(qualified_name name,
+                                         std::vector<std::string> predicates,
+                                         serializer_nodes resources,
+                                         bool const on_demand) :
+    products_consumer{std::move(name), std::move(predicates), std::move(resources)},
+    on_demand_{on_demand}
   {
   }
 
   declared_predicate::~declared_predicate() = default;
+
+  bool declared_predicate::on_demand() const noexcept { return on_demand_; }
 }
@@ -22,13 +22,17 @@
 #include "spdlog/spdlog.h"
 
 #include <array>
+#include <chrono>
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <iterator>
 #include <map>
 #include <memory>
+#include <optional>
 #include <ranges>
+#include <semaphore>
 #include <span>
 #include <stdexcept>
 #include <string>
@@ -40,10 +44,19 @@ namespace meld {
 
   class declared_predicate : public products_consumer {
   public:
-    declared_predicate(qualified_name name, std::vector<std::string> predicates);
+    declared_predicate(qualified_name name,
+                       std::vector<std::string> predicates,
+                       serializer_nodes resources,
+                       bool on_demand);
     virtual ~declared_predicate();
 
+    // An on-demand predicate sends deferred decisions instead of results (see
+    // deferred_decision in meld/core/detail/filter_impl.hpp).
+    bool on_demand() const noexcept;
     virtual tbb::flow::sender<predicate_result>& sender() = 0;
+
+  private:
+    bool on_demand_;
   };
 
   using declared_predicate_ptr = std::unique_ptr<declared_predicate>;
@@ -63,12 +76,14 @@ namespace meld {
                   qualified_name name,
                   std::size_t concurrency,
                   std::vector<std::string> predicates,
+                  serializer_nodes resources,
                   tbb::flow::graph& g,
                   function_t&& f,
                   InputArgs input_args) :
       name_{std::move(name)},
       concurrency_{concurrency},
       predicates_{std::move(predicates)},
+      resources_{std::move(resources)},
       graph_{g},
       ft_{std::move(f)},
       input_args_{std::move(input_args)},
@@ -88,12 +103,28 @@ namespace meld {
       return *this;
     }
 
+    // The predicate is evaluated only for the messages whose consumers have not been
+    // rejected by their other predicates.  Consumers guarded by several on-demand
+    // predicates evaluate them in ascending order of their measured cost per rejection,
+    // skipping the remaining ones once a predicate has returned false.
+    auto& on_demand()
+    {
+      on_demand_ = true;
+      return *this;
+    }
+
   private:
     declared_predicate_ptr create()
     {
+      if (on_demand_ and not empty(resources_)) {
+        throw std::runtime_error("The on-demand predicate " + name_.full() +
+                                 " cannot use resources.");
+      }
       return std::make_unique<complete_predicate>(std::move(name_),
                                                   concurrency_,
                                                   std::move(predicates_),
+                                                  std::move(resources_),
+                                                  on_demand_,
                                                   graph_,
                                                   std::move(ft_),
                                                   std::move(input_args_),
@@ -102,10 +133,12 @@ namespace meld {
     qualified_name name_;
     std::size_t concurrency_;
     std::vector<std::string> predicates_;
+    serializer_nodes resources_;
     tbb::flow::graph& graph_;
     function_t ft_;
     InputArgs input_args_;
     std::array<specified_label, N> product_labels_;
+    bool on_demand_{false};
     registrar<declared_predicates> reg_;
   };
 
@@ -121,43 +154,61 @@ namespace meld {
     using accessor = results_t::accessor;
     using const_accessor = results_t::const_accessor;
 
+    class deferred_call;
+
   public:
     complete_predicate(qualified_name name,
                        std::size_t concurrency,
                        std::vector<std::string> predicates,
+                       serializer_nodes resources,
+                       bool on_demand,
                        tbb::flow::graph& g,
                        function_t&& f,
                        InputArgs input,
                        std::array<specified_label, N> product_labels) :
-      declared_predicate{std::move(name), std::move(predicates)},
+      declared_predicate{std::move(name), std::move(predicates), std::move(resources), on_demand},
       product_labels_{std::move(product_labels)},
       input_{std::move(input)},
+      ft_{std::move(f)},
+      tokens_{make_tokens(concurrency)},
       join_{make_join_or_none(g, std::make_index_sequence<N>{})},
       predicate_{g,
                  concurrency,
-                 [this, ft = std::move(f)](messages_t<N> const& messages) -> predicate_result {
+                 [this](messages_t<N> const& messages, auto& outputs) {
+                   auto const tokens = hold_resources();
                    auto const& msg = most_derived(messages);
                    auto const& [store, message_id] = std::tie(msg.store, msg.id);
-                   predicate_result result{};
+                   std::optional<predicate_result> result;
                    if (store->is_flush()) {
                      flag_for(store->id()->hash()).flush_received(message_id);
                    }
                    else if (const_accessor a; results_.find(a, store->id()->hash())) {
-                     result = {msg.eom, message_id, a->second.result};
+                     result = {msg.eom, message_id, a->second.result, a->second.deferred};
                    }
                    else if (accessor a; results_.insert(a, store->id()->hash())) {
-                     bool const rc = call(ft, messages, std::make_index_sequence<N>{});
-                     result = a->second = {msg.eom, message_id, rc};
+                     if (this->on_demand()) {
+                       // The inputs are released once the deferred call is destroyed.
+                       auto deferred = std::make_shared<deferred_call>(*this, messages);
+                       result = a->second = {msg.eom, message_id, true, std::move(deferred)};
+                     }
+                     else {
+                       bool const rc = call(ft_, messages, std::make_index_sequence<N>{});
+                       finished_with_inputs(input_, messages);
+                       result = a->second = {msg.eom, message_id, rc};
+                     }
                      flag_for(store->id()->hash()).mark_as_processed();
                    }
 
                    if (done_with(store)) {
                      results_.erase(store->id()->hash());
                    }
-                   return result;
-                 }}
+                   // No result is sent for a flush message.
+                   if (result) {
+                     get<0>(outputs).try_put(*result);
+                   }
+                 }},
+      edge_{g, concurrency, join_, predicate_, this->resources()}
     {
-      make_edge(join_, predicate_);
     }
 
     ~complete_predicate()
@@ -174,27 +225,120 @@ namespace meld {
     }
 
     std::vector<tbb::flow::receiver<message>*> ports() override { return input_ports<N>(join_); }
+    void try_put_all(message const& msg, std::span<std::size_t const> depths) override
+    {
+      edge_.try_put_all(msg, depths);
+    }
 
-    tbb::flow::sender<predicate_result>& sender() override { return predicate_; }
+    tbb::flow::sender<predicate_result>& sender() override
+    {
+      return output_port<0ull>(predicate_);
+    }
     specified_labels input() const override { return product_labels_; }
+    void set_consumer_count(specified_label const& product_label,
+                            std::size_t const count) override
+    {
+      meld::set_consumer_count(input_, product_label, count);
+    }
 
     template <std::size_t... Is>
     bool call(function_t const& ft, messages_t<N> const& messages, std::index_sequence<Is...>)
     {
       ++calls_;
+      auto const sentry = time_call();
       return std::invoke(ft, std::get<Is>(input_).retrieve(messages)...);
     }
 
     std::size_t num_calls() const final { return calls_.load(); }
 
+    // Called by the filters of the consumers, outside of the predicate's flow-graph node.
+    // The node's concurrency limit is enforced by holding one of its tokens.
+    bool evaluate(messages_t<N> const& messages)
+    {
+      held_token const token{tokens_.get()};
+      auto const begin = std::chrono::steady_clock::now();
+      bool const rc = call(ft_, messages, std::make_index_sequence<N>{});
+      auto const elapsed = std::chrono::steady_clock::now() - begin;
+      evaluation_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+      rejections_ += not rc;
+      ++evaluations_;
+      return rc;
+    }
+
+    static std::unique_ptr<std::counting_semaphore<>> make_tokens(std::size_t const concurrency)
+    {
+      if (concurrency == tbb::flow::unlimited) {
+        return nullptr;
+      }
+      return std::make_unique<std::counting_semaphore<>>(concurrency);
+    }
+
+    class held_token {
+    public:
+      explicit held_token(std::counting_semaphore<>* tokens) : tokens_{tokens}
+      {
+        if (tokens_) {
+          tokens_->acquire();
+        }
+      }
+      ~held_token()
+      {
+        if (tokens_) {
+          tokens_->release();
+        }
+      }
+
+    private:
+      std::counting_semaphore<>* tokens_;
+    };
+
+    double cost_per_rejection() const
+    {
+      // The rejection rate is smoothed so that predicates that have never rejected a
+      // message (or have not yet been evaluated) are not assigned an infinite ratio.
+      auto const n = static_cast<double>(evaluations_.load());
+      double const mean_cost = n == 0. ? 0. : evaluation_ns_.load() / n;
+      double const rejection_rate = (rejections_.load() + 1.) / (n + 2.);
+      return mean_cost / rejection_rate;
+    }
+
     std::array<specified_label, N> product_labels_;
     InputArgs input_;
+    function_t ft_;
+    std::unique_ptr<std::counting_semaphore<>> tokens_; // Null for unlimited concurrency
+    std::atomic<std::size_t> evaluations_{};
+    std::atomic<std::size_t> rejections_{};
+    std::atomic<std::int64_t> evaluation_ns_{};
     join_or_none_t<N> join_;
-    tbb::flow::function_node<messages_t<N>, predicate_result> predicate_;
+    tbb::flow::
+      multifunction_node<messages_t<N>, std::tuple<predicate_result>, tbb::flow::rejecting>
+        predicate_;
+    ordered_edge<N> edge_;
     results_t results_;
     std::atomic<std::size_t> calls_;
   };
 
+  // =====================================================================================
+
+  template <is_predicate_like FT, typename InputArgs>
+  class pre_predicate<FT, InputArgs>::complete_predicate::deferred_call :
+    public deferred_decision {
+  public:
+    deferred_call(complete_predicate& predicate, messages_t<N> const& messages) :
+      predicate_{predicate}, messages_{messages}
+    {
+    }
+
+    ~deferred_call() { finished_with_inputs(predicate_.input_, messages_); }
+
+    double cost_per_rejection() const override { return predicate_.cost_per_rejection(); }
+
+  private:
+    bool evaluate() override { return predicate_.evaluate(messages_); }
+
+    complete_predicate& predicate_;
+    messages_t<N> messages_;
+  };
 }
 
 #endif // meld_core_declared_predicate_hpp
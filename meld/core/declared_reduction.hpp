@@ -4,10 +4,12 @@
 #include "meld/concurrency.hpp"
 #include "meld/core/concepts.hpp"
 #include "meld/core/detail/port_names.hpp"
+#include "meld/core/end_of_message.hpp"
 #include "meld/core/fwd.hpp"
 #include "meld/core/message.hpp"
 #include "meld/core/node_options.hpp"
 #include "meld/core/products_consumer.hpp"
+#include "meld/core/reduction/results.hpp"
 #include "meld/core/reduction/send.hpp"
 #include "meld/core/registrar.hpp"
 #include "meld/core/store_counters.hpp"
@@ -16,17 +18,20 @@
 #include "meld/model/product_store.hpp"
 #include "meld/model/qualified_name.hpp"
 
-#include "oneapi/tbb/concurrent_unordered_map.h"
+#include "oneapi/tbb/enumerable_thread_specific.h"
 #include "oneapi/tbb/flow_graph.h"
+#include "spdlog/spdlog.h"
 
 #include <array>
 #include <atomic>
 #include <cassert>
+#include <concepts>
 #include <cstddef>
 #include <functional>
 #include <iterator>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <span>
 #include <stdexcept>
 #include <string>
@@ -37,7 +42,9 @@
 namespace meld {
   class declared_reduction : public products_consumer {
   public:
-    declared_reduction(qualified_name name, std::vector<std::string> predicates);
+    declared_reduction(qualified_name name,
+                       std::vector<std::string> predicates,
+                       serializer_nodes resources);
     virtual ~declared_reduction();
 
     virtual tbb::flow::sender<message>& sender() = 0;
@@ -60,6 +67,7 @@ namespace meld {
 
     static constexpr std::size_t M = 1; // hard-coded for now
     using function_t = FT;
+    using merge_function_t = std::function<void(R&, R const&)>;
 
     template <typename InitTuple>
     class total_reduction;
@@ -69,12 +77,14 @@ namespace meld {
                   qualified_name name,
                   std::size_t concurrency,
                   std::vector<std::string> predicates,
+                  serializer_nodes resources,
                   tbb::flow::graph& g,
                   function_t&& f,
                   InputArgs input_args) :
       name_{std::move(name)},
       concurrency_{concurrency},
       predicates_{std::move(predicates)},
+      resources_{std::move(resources)},
       graph_{g},
       ft_{std::move(f)},
       input_args_{std::move(input_args)},
@@ -116,6 +126,27 @@ namespace meld {
       return *this;
     }
 
+    // Each thread accumulates into its own (value-initialized) result object, so that the
+    // reduction function need not be thread-safe.  The partial results of an interval
+    // are merged into the interval's result once all of its stores have been processed.
+    auto& merged_with(std::invocable<R&, R const&> auto merge)
+      requires std::default_initializable<R>
+    {
+      merge_ = std::move(merge);
+      return *this;
+    }
+
+    // The reduction is first computed for each interval of the (intermediate) stage level,
+    // e.g. per subrun for a reduction over runs.  Once all stores of a stage interval have
+    // been processed, its result is combined into the enclosing interval's result using
+    // the function specified with 'merged_with(...)', and the stage result is erased.  Stores
+    // that do not belong to a stage interval are ignored.
+    auto& staged_by(std::string const& level_name)
+    {
+      stage_level_ = level_name;
+      return *this;
+    }
+
   private:
     template <typename T>
     declared_reduction_ptr create(T init)
@@ -124,27 +155,38 @@ namespace meld {
         throw std::runtime_error(
           "The reduction range must be specified using the 'over(...)' syntax.");
       }
+      if (not empty(stage_level_) and not merge_) {
+        throw std::runtime_error("The staged reduction " + name_.full() +
+                                 " requires a combine function, specified using the "
+                                 "'merged_with(...)' syntax.");
+      }
       return std::make_unique<total_reduction<decltype(init)>>(std::move(name_),
                                                                concurrency_,
                                                                std::move(predicates_),
+                                                               std::move(resources_),
                                                                graph_,
                                                                std::move(ft_),
                                                                std::move(init),
                                                                std::move(input_args_),
                                                                std::move(product_labels_),
                                                                std::move(output_names_),
-                                                               std::move(reduction_interval_));
+                                                               std::move(reduction_interval_),
+                                                               std::move(stage_level_),
+                                                               std::move(merge_));
     }
 
     qualified_name name_;
     std::size_t concurrency_;
     std::vector<std::string> predicates_;
+    serializer_nodes resources_;
     tbb::flow::graph& graph_;
     function_t ft_;
     InputArgs input_args_;
     std::array<specified_label, N> product_labels_;
     std::string reduction_interval_{level_id::base().level_name()};
+    std::string stage_level_{};
     std::array<qualified_name, M> output_names_;
+    merge_function_t merge_;
     registrar<declared_reductions> reg_;
   };
 
@@ -153,68 +195,113 @@ namespace meld {
   class pre_reduction<FT, InputArgs>::total_reduction :
     public declared_reduction,
     private count_stores {
+    using partials_t = tbb::enumerable_thread_specific<R>;
 
   public:
     total_reduction(qualified_name name,
                     std::size_t concurrency,
                     std::vector<std::string> predicates,
+                    serializer_nodes resources,
                     tbb::flow::graph& g,
                     function_t&& f,
                     InitTuple initializer,
                     InputArgs input,
                     std::array<specified_label, N> product_labels,
                     std::array<qualified_name, M> output,
-                    std::string reduction_interval) :
-      declared_reduction{std::move(name), std::move(predicates)},
+                    std::string reduction_interval,
+                    std::string stage_level,
+                    merge_function_t merge) :
+      declared_reduction{std::move(name), std::move(predicates), std::move(resources)},
       initializer_{std::move(initializer)},
       product_labels_{std::move(product_labels)},
       input_{std::move(input)},
       output_{std::move(output)},
       reduction_interval_{std::move(reduction_interval)},
+      stage_level_{std::move(stage_level)},
+      accumulation_level_{empty(stage_level_) ? reduction_interval_ : stage_level_},
+      merge_{std::move(merge)},
       join_{make_join_or_none(g, std::make_index_sequence<N>{})},
       reduction_{
         g, concurrency, [this, ft = std::move(f)](messages_t<N> const& messages, auto& outputs) {
           // N.B. The assumption is that a reduction will *never* need to cache
           //      the product store it creates.  Any flush messages *do not* need
           //      to be propagated to downstream nodes.
+          auto const tokens = hold_resources();
           auto const& msg = most_derived(messages);
           auto const& [store, original_message_id] = std::tie(msg.store, msg.original_id);
 
-          if (not store->is_flush() and not store->id()->parent(reduction_interval_)) {
+          if (not store->is_flush() and not store->id()->parent(accumulation_level_)) {
             return;
           }
 
           if (store->is_flush()) {
             // Downstream nodes always get the flush.
             get<0>(outputs).try_put(msg);
-            if (store->id()->level_name() != reduction_interval_) {
+            auto const& level_name = store->id()->level_name();
+            if (level_name != reduction_interval_ and level_name != stage_level_) {
+              return;
+            }
+            // An interval whose child counts have been declared is complete once its last
+            // child has been processed (see below).
+            if (auto const& counts = store->declared_child_counts();
+                level_name == accumulation_level_ and counts and not counts->empty()) {
               return;
             }
           }
 
-          auto const& reduction_store =
-            store->is_flush() ? store : store->parent(reduction_interval_);
-          assert(reduction_store);
-          auto const& id_hash_for_counter = reduction_store->id()->hash();
+          auto const& interval_store =
+            store->is_flush() ? store : store->parent(accumulation_level_);
+          assert(interval_store);
+          auto const& id_hash_for_counter = interval_store->id()->hash();
+          bool const is_stage = interval_store->id()->level_name() == stage_level_;
 
-          if (store->is_flush()) {
-            counter_for(id_hash_for_counter).set_flush_value(store, original_message_id);
+          std::unique_ptr<store_counter> counter;
+          if (is_stage and store->is_flush() and not store->contains_product("[flush]")) {
+            // A stage interval without any stores contributes nothing to the result.
+            counter = finish_stage(*interval_store);
           }
           else {
-            call(ft, messages, std::make_index_sequence<N>{});
-            counter_for(id_hash_for_counter).increment(store->id()->level_hash());
+            if (store->is_flush()) {
+              counter_for(id_hash_for_counter).set_flush_value(store, original_message_id);
+            }
+            else {
+              call(ft, messages, std::make_index_sequence<N>{});
+              finished_with_inputs(input_, messages);
+              bool created{false};
+              auto& counter = counter_for(id_hash_for_counter, created);
+              // The declared counts are set once per interval, by whichever child creates
+              // its counter.
+              if (auto const& counts = interval_store->declared_child_counts();
+                  created and counts) {
+                counter.set_flush_value(counts, msg.eom->message_id_for(*interval_store->id()));
+              }
+              counter.increment(store->id()->level_hash());
+            }
+            counter = done_with(id_hash_for_counter);
+            if (counter and is_stage) {
+              counter = finish_stage(*interval_store);
+            }
           }
 
-          if (auto counter = done_with(id_hash_for_counter)) {
+          if (counter) {
+            auto const& reduction_store =
+              is_stage ? interval_store->parent(reduction_interval_) : interval_store;
             auto parent = reduction_store->make_continuation(this->full_name());
             commit_(*parent);
             ++product_count_;
             // FIXME: This msg.eom value may be wrong!
             get<0>(outputs).try_put({parent, msg.eom, counter->original_message_id()});
           }
-        }}
+        }},
+      edge_{g, concurrency, join_, reduction_, this->resources()}
     {
-      make_edge(join_, reduction_);
+    }
+
+    ~total_reduction()
+    {
+      if (auto const uncommitted = results_.size() + partials_.size(); uncommitted > 0ull) {
+        spdlog::warn("Reduction {} has {} uncommitted results.", full_name(), uncommitted);
+      }
     }
 
   private:
@@ -224,28 +311,38 @@ namespace meld {
     }
 
     std::vector<tbb::flow::receiver<message>*> ports() override { return input_ports<N>(join_); }
+    void try_put_all(message const& msg, std::span<std::size_t const> depths) override
+    {
+      edge_.try_put_all(msg, depths);
+    }
+
+    std::vector<std::string> flush_levels() const override
+    {
+      if (empty(stage_level_)) {
+        return {reduction_interval_};
+      }
+      return {reduction_interval_, stage_level_};
+    }
 
     tbb::flow::sender<message>& sender() override { return output_port<0ull>(reduction_); }
     tbb::flow::sender<message>& to_output() override { return sender(); }
     specified_labels input() const override { return product_labels_; }
+    void set_consumer_count(specified_label const& product_label,
+                            std::size_t const count) override
+    {
+      meld::set_consumer_count(input_, product_label, count);
+    }
     qualified_names output() const override { return output_; }
 
     template <std::size_t... Is>
     void call(function_t const& ft, messages_t<N> const& messages, std::index_sequence<Is...>)
     {
-      auto const& parent_id = *most_derived(messages).store->id()->parent(reduction_interval_);
-      // FIXME: Not the safest approach!
-      auto it = results_.find(parent_id);
-      if (it == results_.end()) {
-        it =
-          results_
-            .insert({parent_id,
-                     initialized_object(std::move(initializer_),
-                                        std::make_index_sequence<std::tuple_size_v<InitTuple>>{})})
-            .first;
-      }
+      auto const interval = most_derived(messages).store->id()->parent(accumulation_level_)->hash();
+      auto& result = merge_ ? partials_.get_or_make(interval, make_partials).local()
+                            : results_.get_or_make(interval, [this] { return initial_result(); });
       ++calls_;
-      return std::invoke(ft, *it->second, std::get<Is>(input_).retrieve(messages)...);
+      auto const sentry = time_call();
+      return std::invoke(ft, result, std::get<Is>(input_).retrieve(messages)...);
     }
 
     std::size_t num_calls() const final { return calls_.load(); }
@@ -258,18 +355,64 @@ namespace meld {
         new R{std::forward<std::tuple_element_t<Is, InitTuple>>(std::get<Is>(tuple))...}};
     }
 
+    std::unique_ptr<R> initial_result()
+    {
+      return initialized_object(std::move(initializer_),
+                                std::make_index_sequence<std::tuple_size_v<InitTuple>>{});
+    }
+
+    static auto make_partials() { return std::make_unique<partials_t>(); }
+
+    // Combines the result of a completed stage interval into the result of its enclosing
+    // reduction interval.  Returns the reduction interval's counter if that interval is
+    // also complete.
+    std::unique_ptr<store_counter> finish_stage(product_store const& stage_store)
+    {
+      auto const& reduction_id = stage_store.parent(reduction_interval_)->id();
+      if (auto partials = partials_.release(stage_store.id()->hash())) {
+        std::lock_guard lock{stage_mutex_};
+        auto& result =
+          results_.get_or_make(reduction_id->hash(), [this] { return initial_result(); });
+        for (auto const& partial : *partials) {
+          merge_(result, partial);
+        }
+      }
+      counter_for(reduction_id->hash()).increment(stage_store.id()->level_hash());
+      return done_with(reduction_id->hash());
+    }
+
+    std::unique_ptr<R> release_result(level_id::hash_type const interval)
+    {
+      if (not empty(stage_level_)) {
+        auto result = results_.release(interval);
+        return result ? std::move(result) : initial_result();
+      }
+      if (not merge_) {
+        return results_.release(interval);
+      }
+      auto result = initial_result();
+      if (auto partials = partials_.release(interval)) {
+        for (auto const& partial : *partials) {
+          merge_(*result, partial);
+        }
+      }
+      return result;
+    }
+
     void commit_(product_store& store)
     {
-      auto& result = results_.at(*store.id());
+      // All stores of the interval have been processed, so the result can be erased.
+      auto result = release_result(store.id()->hash());
+      if (not result) {
+        throw std::runtime_error("Reduction " + full_name() + " has no result for " +
+                                 store.id()->to_string() + '.');
+      }
       if constexpr (requires { send(*result); }) {
         store.add_product(output()[0].full(), send(*result));
       }
       else {
         store.add_product(output()[0].full(), std::move(*result));
       }
-      // Reclaim some memory; it would be better to erase the entire entry from the map,
-      // but that is not thread-safe.
-      result.reset();
     }
 
     InitTuple initializer_;
@@ -277,9 +420,15 @@ namespace meld {
     InputArgs input_;
     std::array<qualified_name, M> output_;
     std::string reduction_interval_;
+    std::string stage_level_;
+    std::string accumulation_level_;
+    merge_function_t merge_;
     join_or_none_t<N> join_;
-    tbb::flow::multifunction_node<messages_t<N>, messages_t<1>> reduction_;
-    tbb::concurrent_unordered_map<level_id, std::unique_ptr<R>> results_;
+    tbb::flow::multifunction_node<messages_t<N>, messages_t<1>, tbb::flow::rejecting> reduction_;
+    ordered_edge<N> edge_;
+    reduction_results<R> results_;
+    reduction_results<partials_t> partials_; // Used only if results are merged
+    std::mutex stage_mutex_;                 // Guards combining stage results
     std::atomic<std::size_t> calls_;
     std::atomic<std::size_t> product_count_;
   };
@@ -16,22 +16,28 @@ namespace meld {
   product_store_const_ptr generator::make_child(std::size_t const i, products new_products)
   {
     auto child = parent_->make_child(i, new_level_name_, node_name_, std::move(new_products));
-    ++child_counts_[child->id()->level_hash()];
+    ++child_count_;
     return child;
   }
 
   product_store_const_ptr generator::flush_store() const
   {
     auto result = parent_->make_flush();
-    if (not child_counts_.empty()) {
-      result->add_product("[flush]",
-                          std::make_shared<flush_counts const>(std::move(child_counts_)));
+    if (auto const count = child_count_.load(); count > 0ull) {
+      // All children belong to the same level.
+      auto const level_hash = parent_->id()->make_child(0ull, new_level_name_)->level_hash();
+      result->add_product(
+        "[flush]",
+        std::make_shared<flush_counts const>(std::map<level_id::hash_type, std::size_t>{
+          {level_hash, count}}));
     }
     return result;
   }
 
-  declared_splitter::declared_splitter(qualified_name name, std::vector<std::string> predicates) :
-    products_consumer{std::move(name), std::move(predicates)}
+  declared_splitter::declared_splitter(qualified_name name,
+                                       std::vector<std::string> predicates,
+                                       serializer_nodes resources) :
+    products_consumer{std::move(name), std::move(predicates), std::move(resources)}
   {
   }
 
@@ -13,15 +13,21 @@
 #include "meld/model/handle.hpp"
 #include "meld/model/level_id.hpp"
 #include "meld/model/product_store.hpp"
+#include "meld/model/product_view.hpp"
 #include "meld/model/qualified_name.hpp"
+#include "meld/utilities/sequence.hpp"
 #include "meld/utilities/sized_tuple.hpp"
 
+#include "oneapi/tbb/blocked_range.h"
 #include "oneapi/tbb/concurrent_hash_map.h"
 #include "oneapi/tbb/flow_graph.h"
+#include "oneapi/tbb/parallel_for.h"
+#include "oneapi/tbb/spin_mutex.h"
 #include "spdlog/spdlog.h"
 
 #include <array>
 #include <atomic>
+#include <concepts>
 #include <cstddef>
 #include <functional>
 #include <iterator>
@@ -36,6 +42,21 @@
 
 namespace meld {
 
+  // An unfold whose children can be created independently of each other: 'size' returns
+  // the number of children, and 'element' returns the products of the child with the
+  // given index.  Such children are created in parallel chunks.
+  template <typename Object, typename Size, typename Element>
+  concept indexed_unfold = std::is_invocable_r_v<std::size_t, Size const&, Object const&> &&
+                           std::invocable<Element const&, Object const&, std::size_t>;
+
+  // A lazy unfold is a coroutine that yields the products of each child.  It is resumed
+  // only while the number of outstanding children of its parent is below a given bound.
+  template <typename Object, typename Unfold>
+  concept lazy_unfold =
+    std::invocable<Unfold const&, Object const&> &&
+    is_sequence_v<std::remove_cvref_t<std::invoke_result_t<Unfold const&, Object const&>>>;
+
+  // The generator's children may be made concurrently.
   class generator {
   public:
     explicit generator(product_store_const_ptr const& parent,
@@ -54,17 +75,20 @@ namespace meld {
     product_store_ptr parent_;
     std::string const& node_name_;
     std::string const& new_level_name_;
-    std::map<level_id::hash_type, std::size_t> child_counts_;
+    std::atomic<std::size_t> child_count_{};
   };
 
   class declared_splitter : public products_consumer {
   public:
-    declared_splitter(qualified_name name, std::vector<std::string> predicates);
+    declared_splitter(qualified_name name,
+                      std::vector<std::string> predicates,
+                      serializer_nodes resources);
     virtual ~declared_splitter();
 
     virtual tbb::flow::sender<message>& to_output() = 0;
     virtual qualified_names output() const = 0;
-    virtual void finalize(multiplexer::head_ports_t head_ports) = 0;
+    virtual void finalize(multiplexer::head_ports_t head_ports,
+                          multiplexer::nodes_t const& nodes) = 0;
     virtual std::size_t product_count() const = 0;
     virtual multiplexer::head_ports_t const& downstream_ports() const = 0;
   };
@@ -72,6 +96,30 @@ namespace meld {
   using declared_splitter_ptr = std::unique_ptr<declared_splitter>;
   using declared_splitters = std::map<std::string, declared_splitter_ptr>;
 
+  namespace detail {
+    // The type of the products created for each child
+    template <typename Object, typename Predicate, typename Unfold>
+    auto unfolded_products()
+    {
+      if constexpr (lazy_unfold<Object, Unfold>) {
+        using sequence_t = std::invoke_result_t<Unfold const&, Object const&>;
+        return std::type_identity<typename sequence_t::value_type>{};
+      }
+      else if constexpr (indexed_unfold<Object, Predicate, Unfold>) {
+        return std::type_identity<std::invoke_result_t<Unfold const&, Object const&, std::size_t>>{};
+      }
+      else {
+        using running_value_t = std::decay_t<decltype(std::declval<Object&>().initial_value())>;
+        using result_t = std::invoke_result_t<Unfold const&, Object&, running_value_t&>;
+        return std::type_identity<std::tuple_element_t<1, std::remove_cvref_t<result_t>>>{};
+      }
+    }
+
+    template <typename Object, typename Predicate, typename Unfold>
+    using unfolded_products_t =
+      typename decltype(unfolded_products<Object, Predicate, Unfold>())::type;
+  }
+
   // =====================================================================================
 
   template <typename Object, typename Predicate, typename Unfold, typename InputArgs>
@@ -86,6 +134,7 @@ namespace meld {
                      qualified_name name,
                      std::size_t concurrency,
                      std::vector<std::string> predicates,
+                     serializer_nodes resources,
                      tbb::flow::graph& g,
                      Predicate&& predicate,
                      Unfold&& unfold,
@@ -93,6 +142,7 @@ namespace meld {
       name_{std::move(name)},
       concurrency_{concurrency},
       predicates_{std::move(predicates)},
+      resources_{std::move(resources)},
       graph_{g},
       predicate_{std::move(predicate)},
       unfold_{std::move(unfold)},
@@ -122,31 +172,54 @@ namespace meld {
       return *this;
     }
 
+    // A lazy unfold is resumed only while fewer than 'n' children of its parent store are
+    // being processed.
+    auto& max_outstanding(std::size_t const n)
+      requires lazy_unfold<Object, Unfold>
+    {
+      max_outstanding_ = n;
+      return *this;
+    }
+
   private:
     template <std::size_t M>
     declared_splitter_ptr create(std::array<qualified_name, M> outputs)
     {
+      if constexpr (lazy_unfold<Object, Unfold>) {
+        if (max_outstanding_ == 0ull) {
+          throw std::runtime_error("The maximum number of outstanding children for unfold " +
+                                   name_.full() + " must be greater than zero.");
+        }
+        if (not empty(resources_)) {
+          throw std::runtime_error("The lazy unfold " + name_.full() +
+                                   " cannot use shared resources.");
+        }
+      }
       return std::make_unique<complete_splitter<M>>(std::move(name_),
                                                     concurrency_,
                                                     std::move(predicates_),
+                                                    std::move(resources_),
                                                     graph_,
                                                     std::move(predicate_),
                                                     std::move(unfold_),
                                                     std::move(input_args_),
                                                     std::move(product_labels_),
                                                     std::move(outputs),
-                                                    std::move(new_level_name_));
+                                                    std::move(new_level_name_),
+                                                    max_outstanding_);
     }
 
     qualified_name name_;
     std::size_t concurrency_;
     std::vector<std::string> predicates_;
+    serializer_nodes resources_;
     tbb::flow::graph& graph_;
     Predicate predicate_;
     Unfold unfold_;
     InputArgs input_args_;
     std::array<specified_label, N> product_labels_;
     std::string new_level_name_;
+    std::size_t max_outstanding_{-1ull};
     registrar<declared_splitters> reg_;
   };
 
@@ -161,40 +234,86 @@ namespace meld {
     using accessor = stores_t::accessor;
     using const_accessor = stores_t::const_accessor;
 
+    static constexpr bool creates_views =
+      contains_product_views_v<detail::unfolded_products_t<Object, Predicate, Unfold>>;
+
+    // The state of a lazy unfold for one parent store
+    struct unfolding {
+      unfolding(complete_splitter& splitter,
+                Unfold const& unfold,
+                message const& msg,
+                messages_t<N> const& msgs) :
+        messages{msgs},
+        gen{msg.store, splitter.full_name(), splitter.new_level_name_},
+        eom{msg.eom},
+        original_message_id{splitter.msg_counter_},
+        obj{splitter.make_object(messages, std::make_index_sequence<N>{})},
+        children{std::invoke(unfold, std::as_const(obj))}
+      {
+      }
+
+      messages_t<N> messages;
+      generator gen;
+      end_of_message_ptr eom;
+      std::size_t original_message_id;
+      Object obj;
+      std::invoke_result_t<Unfold const&, Object const&> children;
+      std::size_t next_child{};
+      std::size_t outstanding{};
+      bool waiting{false};
+      tbb::spin_mutex mutex;
+    };
+    using unfolding_ptr = std::shared_ptr<unfolding>;
+    using resume_node = tbb::flow::function_node<unfolding_ptr>;
+
   public:
     complete_splitter(qualified_name name,
                       std::size_t concurrency,
                       std::vector<std::string> predicates,
+                      serializer_nodes resources,
                       tbb::flow::graph& g,
                       Predicate&& predicate,
                       Unfold&& unfold,
                       InputArgs input,
                       std::array<specified_label, N> product_labels,
                       std::array<qualified_name, M> output_products,
-                      std::string new_level_name) :
-      declared_splitter{std::move(name), std::move(predicates)},
+                      std::string new_level_name,
+                      std::size_t max_outstanding) :
+      declared_splitter{std::move(name), std::move(predicates), std::move(resources)},
       product_labels_{std::move(product_labels)},
       input_{std::move(input)},
       output_{std::move(output_products)},
+      output_ids_{to_product_ids(output_)},
       new_level_name_{std::move(new_level_name)},
+      max_outstanding_{max_outstanding},
       multiplexer_{g},
       join_{make_join_or_none(g, std::make_index_sequence<N>{})},
       splitter_{g,
                 concurrency,
                 [this, p = std::move(predicate), ufold = std::move(unfold)](
                   messages_t<N> const& messages) -> tbb::flow::continue_msg {
+                  auto const tokens = hold_resources();
                   auto const& msg = most_derived(messages);
                   auto const& store = msg.store;
                   if (store->is_flush()) {
                     flag_for(store->id()->hash()).flush_received(msg.id);
                   }
                   else if (accessor a; stores_.insert(a, store->id()->hash())) {
-                    std::size_t const original_message_id{msg_counter_};
-                    generator g{msg.store, this->full_name(), new_level_name_};
-                    call(p, ufold, g, msg.eom, messages, std::make_index_sequence<N>{});
-                    multiplexer_.try_put(
-                      {g.flush_store(), msg.eom, ++msg_counter_, original_message_id});
-                    flag_for(store->id()->hash()).mark_as_processed();
+                    if constexpr (lazy_unfold<Object, Unfold>) {
+                      // The store is marked as processed once the coroutine has finished.
+                      a.release();
+                      resume(std::make_shared<unfolding>(*this, ufold, msg, messages));
+                      return {};
+                    }
+                    else {
+                      std::size_t const original_message_id{msg_counter_};
+                      generator g{msg.store, this->full_name(), new_level_name_};
+                      call(p, ufold, g, msg.eom, messages, std::make_index_sequence<N>{});
+                      release_inputs(messages);
+                      multiplexer_.try_put(
+                        {g.flush_store(), msg.eom, ++msg_counter_, original_message_id});
+                      flag_for(store->id()->hash()).mark_as_processed();
+                    }
                   }
 
                   if (done_with(store)) {
@@ -202,10 +321,17 @@ namespace meld {
                   }
                   return {};
                 }},
+      edge_{g, concurrency, join_, splitter_, this->resources()},
       to_output_{g}
     {
-      make_edge(join_, splitter_);
       make_edge(to_output_, multiplexer_);
+      if constexpr (lazy_unfold<Object, Unfold>) {
+        resume_ = std::make_shared<resume_node>(
+          g, concurrency, [this](unfolding_ptr const& state) -> tbb::flow::continue_msg {
+            resume(state);
+            return {};
+          });
+      }
     }
 
     ~complete_splitter()
@@ -224,15 +350,25 @@ namespace meld {
       return receiver_for<N>(join_, product_labels_, product_label);
     }
     std::vector<tbb::flow::receiver<message>*> ports() override { return input_ports<N>(join_); }
+    void try_put_all(message const& msg, std::span<std::size_t const> depths) override
+    {
+      edge_.try_put_all(msg, depths);
+    }
 
     tbb::flow::sender<message>& to_output() override { return to_output_; }
 
     specified_labels input() const override { return product_labels_; }
+    void set_consumer_count(specified_label const& product_label,
+                            std::size_t const count) override
+    {
+      meld::set_consumer_count(input_, product_label, count);
+    }
     qualified_names output() const override { return output_; }
 
-    void finalize(multiplexer::head_ports_t head_ports) override
+    void finalize(multiplexer::head_ports_t head_ports,
+                  multiplexer::nodes_t const& nodes) override
     {
-      multiplexer_.finalize(std::move(head_ports));
+      multiplexer_.finalize(std::move(head_ports), nodes);
     }
 
     multiplexer::head_ports_t const& downstream_ports() const override
@@ -249,17 +385,129 @@ namespace meld {
               std::index_sequence<Is...>)
     {
       ++calls_;
+      auto const sentry = time_call();
       Object obj(std::get<Is>(input_).retrieve(messages)...);
-      std::size_t counter = 0;
-      auto running_value = obj.initial_value();
-      while (std::invoke(predicate, obj, running_value)) {
-        auto [next_value, prods] = std::invoke(unfold, obj, running_value);
-        ++product_count_;
-        products new_products;
-        new_products.add_all(output_, prods);
-        auto child = g.make_child_for(counter++, std::move(new_products));
-        to_output_.try_put({child, eom->make_child(child->id()), ++msg_counter_});
-        running_value = next_value;
+      if constexpr (indexed_unfold<Object, Predicate, Unfold>) {
+        unfold_indexed(obj, predicate, unfold, g, eom);
+      }
+      else {
+        std::size_t counter = 0;
+        auto running_value = obj.initial_value();
+        while (std::invoke(predicate, obj, running_value)) {
+          auto [next_value, prods] = std::invoke(unfold, obj, running_value);
+          emit(g, eom, counter++, std::move(prods));
+          running_value = std::move(next_value);
+        }
+      }
+    }
+
+    void unfold_indexed(Object const& obj,
+                        Predicate const& size,
+                        Unfold const& element,
+                        generator& g,
+                        end_of_message_ptr const& eom)
+    {
+      std::size_t const n = std::invoke(size, obj);
+      auto make_children = [&](tbb::blocked_range<std::size_t> const& r) {
+        for (std::size_t i = r.begin(); i != r.end(); ++i) {
+          emit(g, eom, i, std::invoke(element, obj, i));
+        }
+      };
+      // A node that holds shared resources must not invoke its functions concurrently.
+      if (empty(this->resources())) {
+        tbb::parallel_for(tbb::blocked_range<std::size_t>{0ull, n}, make_children);
+      }
+      else {
+        make_children(tbb::blocked_range<std::size_t>{0ull, n});
+      }
+    }
+
+    template <typename T>
+    void emit(generator& g,
+              end_of_message_ptr const& eom,
+              std::size_t const i,
+              T&& prods,
+              std::shared_ptr<void> ticket = nullptr)
+    {
+      ++product_count_;
+      products new_products;
+      new_products.add_all(output_ids_, std::forward<T>(prods));
+      auto child = g.make_child_for(i, std::move(new_products));
+      to_output_.try_put(
+        {child,
+         eom->make_child(child->id(), nullptr, std::move(ticket)),
+         ++msg_counter_});
+    }
+
+    // The payloads of products viewed by the children must outlive the children, so they
+    // are not released early (see product_view.hpp).
+    void release_inputs(messages_t<N> const& messages)
+    {
+      if constexpr (not creates_views) {
+        finished_with_inputs(input_, messages);
+      }
+    }
+
+    template <std::size_t... Is>
+    Object make_object(messages_t<N> const& messages, std::index_sequence<Is...>)
+    {
+      return Object(std::get<Is>(input_).retrieve(messages)...);
+    }
+
+    // Resumes the coroutine of a lazy unfold until it has either finished or yielded the
+    // maximum number of outstanding children.  In the latter case, the coroutine is
+    // resumed (through the resume_ node) once one of the children has been processed.
+    void resume(unfolding_ptr const& state)
+    {
+      auto const sentry = time_call();
+      while (true) {
+        {
+          tbb::spin_mutex::scoped_lock lock{state->mutex};
+          if (state->outstanding == max_outstanding_) {
+            state->waiting = true;
+            return;
+          }
+          ++state->outstanding;
+        }
+        if (not state->children.next()) {
+          finish(*state);
+          return;
+        }
+        emit(state->gen,
+             state->eom,
+             state->next_child++,
+             state->children.take(),
+             max_outstanding_ == -1ull ? nullptr : make_ticket(state));
+      }
+    }
+
+    // The ticket is destroyed together with the child's end_of_message object.
+    std::shared_ptr<void> make_ticket(unfolding_ptr state)
+    {
+      return std::shared_ptr<void>{
+        nullptr, [node = std::weak_ptr{resume_}, state = std::move(state)](void*) {
+          bool resume_now = false;
+          {
+            tbb::spin_mutex::scoped_lock lock{state->mutex};
+            --state->outstanding;
+            resume_now = std::exchange(state->waiting, false);
+          }
+          if (auto resumer = node.lock(); resumer and resume_now) {
+            resumer->try_put(state);
+          }
+        }};
+    }
+
+    void finish(unfolding& state)
+    {
+      ++calls_;
+      multiplexer_.try_put(
+        {state.gen.flush_store(), state.eom, ++msg_counter_, state.original_message_id});
+      release_inputs(state.messages);
+      auto const& store = most_derived(state.messages).store;
+      flag_for(store->id()->hash()).mark_as_processed();
+      if (done_with(store)) {
+        stores_.erase(store->id()->hash());
       }
     }
 
@@ -269,11 +517,16 @@ namespace meld {
     std::array<specified_label, N> product_labels_;
     InputArgs input_;
     std::array<qualified_name, M> output_;
+    std::array<product_id, M> output_ids_;
     std::string new_level_name_;
+    std::size_t max_outstanding_; // Used only for lazy unfolds
     multiplexer multiplexer_;
     join_or_none_t<N> join_;
-    tbb::flow::function_node<messages_t<N>> splitter_;
+    tbb::flow::function_node<messages_t<N>, tbb::flow::continue_msg, tbb::flow::rejecting>
+      splitter_;
+    ordered_edge<N> edge_;
     tbb::flow::broadcast_node<message> to_output_;
+    std::shared_ptr<resume_node> resume_; // Used only for lazy unfolds
     tbb::concurrent_hash_map<level_id::hash_type, product_store_ptr> stores_;
     std::atomic<std::size_t> msg_counter_{}; // Is this sufficient?  Probably not.
     std::atomic<std::size_t> calls_{};
@@ -1,10 +1,31 @@
 #include "meld/core/declared_transform.hpp"
 
 namespace meld {
-  declared_transform::declared_transform(qualified_name name, std::vector<std::string> predicates) :
-    products_consumer{std::move(name), std::move(predicates)}
+  declared_transform::declared_transform(qualified_name name,
+                                         std::vector<std::string> predicates,
+                                         serializer_nodes resources) :
+    products_consumer{std::move(name), std::move(predicates), std::move(resources)}
   {
   }
 
   declared_transform::~declared_transform() = default;
+
+  void declared_transform::fuse(declared_transform& downstream) noexcept
+  {
+    downstream_ = &downstream;
+  }
+
+  void declared_transform::send_downstream(message msg)
+  {
+    auto* current = this;
+    while (current->downstream_) {
+      current = current->downstream_;
+      auto next = current->process_fused(msg);
+      if (not next) {
+        return;
+      }
+      msg = std::move(*next);
+    }
+    current->put_downstream(msg);
+  }
 }
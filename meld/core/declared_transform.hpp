@@ -31,6 +31,7 @@
 #include <iterator>
 #include <map>
 #include <memory>
+#include <optional>
 #include <ranges>
 #include <span>
 #include <stdexcept>
@@ -42,13 +43,38 @@ namespace meld {
 
   class declared_transform : public products_consumer {
   public:
-    declared_transform(qualified_name name, std::vector<std::string> predicates);
+    declared_transform(qualified_name name,
+                       std::vector<std::string> predicates,
+                       serializer_nodes resources);
     virtual ~declared_transform();
 
     virtual tbb::flow::sender<message>& sender() = 0;
     virtual tbb::flow::sender<message>& to_output() = 0;
     virtual qualified_names output() const = 0;
     virtual std::size_t product_count() const = 0;
+
+    // A transform with unlimited concurrency and no shared resources, whose body may thus
+    // run on behalf of another transform without changing its constraints.
+    virtual bool unrestricted() const = 0;
+
+    // A transform that can be invoked directly from the body of the transform producing
+    // its only input (see edge_maker::fuse_the_edge).  Such a transform must have one
+    // input and be unrestricted.
+    virtual bool fusible() const = 0;
+    void fuse(declared_transform& downstream) noexcept;
+
+  protected:
+    // Hands the message to the fused downstream transforms on the calling thread, and sends
+    // the message produced by the last of them through the flow graph.  The chain of fused
+    // transforms is traversed iteratively, so that long chains do not deepen the stack.
+    void send_downstream(message msg);
+
+  private:
+    // Returns the message to be sent downstream, if any
+    virtual std::optional<message> process_fused(message const& msg) = 0;
+    virtual void put_downstream(message const& msg) = 0;
+
+    declared_transform* downstream_{nullptr};
   };
 
   using declared_transform_ptr = std::unique_ptr<declared_transform>;
@@ -70,12 +96,14 @@ namespace meld {
                   qualified_name name,
                   std::size_t concurrency,
                   std::vector<std::string> predicates,
+                  serializer_nodes resources,
                   tbb::flow::graph& g,
                   function_t&& f,
                   InputArgs input_args) :
       name_{std::move(name)},
       concurrency_{concurrency},
       predicates_{std::move(predicates)},
+      resources_{std::move(resources)},
       graph_{g},
       ft_{std::move(f)},
       input_args_{std::move(input_args)},
@@ -123,6 +151,7 @@ namespace meld {
       return std::make_unique<total_transform<M>>(std::move(name_),
                                                   concurrency_,
                                                   std::move(predicates_),
+                                                  std::move(resources_),
                                                   graph_,
                                                   std::move(ft_),
                                                   std::move(input_args_),
@@ -133,6 +162,7 @@ namespace meld {
     qualified_name name_;
     std::size_t concurrency_;
     std::vector<std::string> predicates_;
+    serializer_nodes resources_;
     tbb::flow::graph& graph_;
     function_t ft_;
     InputArgs input_args_;
@@ -155,52 +185,34 @@ namespace meld {
     total_transform(qualified_name name,
                     std::size_t concurrency,
                     std::vector<std::string> predicates,
+                    serializer_nodes resources,
                     tbb::flow::graph& g,
                     function_t&& f,
                     InputArgs input,
                     std::array<specified_label, N> product_labels,
                     std::array<qualified_name, M> output) :
-      declared_transform{std::move(name), std::move(predicates)},
+      declared_transform{std::move(name), std::move(predicates), std::move(resources)},
       product_labels_{std::move(product_labels)},
       input_{std::move(input)},
       output_{std::move(output)},
+      output_ids_{to_product_ids(output_)},
       join_{make_join_or_none(g, std::make_index_sequence<N>{})},
-      transform_{
-        g, concurrency, [this, ft = std::move(f)](messages_t<N> const& messages, auto& output) {
-          auto const& msg = most_derived(messages);
-          auto const& [store, message_eom, message_id] = std::tie(msg.store, msg.eom, msg.id);
-          auto& [stay_in_graph, to_output] = output;
-          if (store->is_flush()) {
-            flag_for(store->id()->hash()).flush_received(msg.original_id);
-            stay_in_graph.try_put(msg);
-            to_output.try_put(msg);
-          }
-          else {
-            accessor a;
-            if (stores_.insert(a, store->id()->hash())) {
-              auto result = call(ft, messages, std::make_index_sequence<N>{});
-              ++calls_;
-              ++product_count_[store->id()->level_hash()];
-              products new_products;
-              new_products.add_all(output_, std::move(result));
-              a->second = store->make_continuation(this->full_name(), std::move(new_products));
-
-              message const new_msg{a->second, msg.eom, message_id};
-              stay_in_graph.try_put(new_msg);
-              to_output.try_put(new_msg);
-              flag_for(store->id()->hash()).mark_as_processed();
-            }
-            else {
-              stay_in_graph.try_put({a->second, msg.eom, message_id});
-            }
-          }
-
-          if (done_with(store)) {
-            stores_.erase(store->id()->hash());
-          }
-        }}
+      ft_{std::move(f)},
+      unrestricted_{concurrency == tbb::flow::unlimited and empty(this->resources())},
+      transform_{g,
+                 concurrency,
+                 [this](messages_t<N> const& messages, auto& output) {
+                   std::optional<message> downstream_msg;
+                   {
+                     auto const tokens = hold_resources();
+                     downstream_msg = process(messages, output);
+                   }
+                   if (downstream_msg) {
+                     send_downstream(std::move(*downstream_msg));
+                   }
+                 }},
+      edge_{g, concurrency, join_, transform_, this->resources()}
     {
-      make_edge(join_, transform_);
     }
 
     ~total_transform()
@@ -220,15 +232,80 @@ namespace meld {
     }
 
     std::vector<tbb::flow::receiver<message>*> ports() override { return input_ports<N>(join_); }
+    void try_put_all(message const& msg, std::span<std::size_t const> depths) override
+    {
+      edge_.try_put_all(msg, depths);
+    }
+
+    using node_t =
+      tbb::flow::multifunction_node<messages_t<N>, messages_t<2u>, tbb::flow::rejecting>;
+
+    // Returns the message for the downstream nodes, which is sent by the caller once the
+    // transform's own bookkeeping is done (see send_downstream).
+    std::optional<message> process(messages_t<N> const& messages,
+                                   typename node_t::output_ports_type& output)
+    {
+      auto const& msg = most_derived(messages);
+      auto const& [store, message_eom, message_id] = std::tie(msg.store, msg.eom, msg.id);
+      auto& to_output = std::get<1>(output);
+      std::optional<message> result;
+      if (store->is_flush()) {
+        flag_for(store->id()->hash()).flush_received(msg.original_id);
+        to_output.try_put(msg);
+        result = msg;
+      }
+      else if (accessor a; stores_.insert(a, store->id()->hash())) {
+        auto products_out = call(ft_, messages, std::make_index_sequence<N>{});
+        finished_with_inputs(input_, messages);
+        ++calls_;
+        ++product_count_[store->id()->level_hash()];
+        products new_products;
+        new_products.add_all(output_ids_, std::move(products_out));
+        a->second = store->make_continuation(this->full_name(), std::move(new_products));
+        result = message{a->second, msg.eom, message_id};
+        a.release();
+
+        to_output.try_put(*result);
+        flag_for(store->id()->hash()).mark_as_processed();
+      }
+      else {
+        result = message{a->second, msg.eom, message_id, -1ull, true};
+      }
+
+      if (done_with(store)) {
+        stores_.erase(store->id()->hash());
+      }
+      return result;
+    }
+
+    bool unrestricted() const override { return unrestricted_; }
+    bool fusible() const override { return N == 1ull and unrestricted_; }
+    std::optional<message> process_fused(message const& msg) override
+    {
+      if constexpr (N == 1ull) {
+        return process(messages_t<1ull>{msg}, transform_.output_ports());
+      }
+      else {
+        throw std::runtime_error("Transform " + full_name() + " with " + std::to_string(N) +
+                                 " inputs cannot be fused with its producer.");
+      }
+    }
+    void put_downstream(message const& msg) override { output_port<0>(transform_).try_put(msg); }
 
     tbb::flow::sender<message>& sender() override { return output_port<0>(transform_); }
     tbb::flow::sender<message>& to_output() override { return output_port<1>(transform_); }
     specified_labels input() const override { return product_labels_; }
+    void set_consumer_count(specified_label const& product_label,
+                            std::size_t const count) override
+    {
+      meld::set_consumer_count(input_, product_label, count);
+    }
     qualified_names output() const override { return output_; }
 
     template <std::size_t... Is>
     auto call(function_t const& ft, messages_t<N> const& messages, std::index_sequence<Is...>)
     {
+      auto const sentry = time_call();
       return std::invoke(ft, std::get<Is>(input_).retrieve(messages)...);
     }
 
@@ -245,8 +322,12 @@ namespace meld {
     std::array<specified_label, N> product_labels_;
     InputArgs input_;
     std::array<qualified_name, M> output_;
+    std::array<product_id, M> output_ids_;
     join_or_none_t<N> join_;
-    tbb::flow::multifunction_node<messages_t<N>, messages_t<2u>> transform_;
+    function_t ft_;
+    bool const unrestricted_;
+    node_t transform_;
+    ordered_edge<N> edge_;
     stores_t stores_;
     std::atomic<std::size_t> calls_;
     tbb::concurrent_unordered_map<std::size_t, std::atomic<std::size_t>> product_count_;
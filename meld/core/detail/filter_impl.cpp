@@ -1,93 +1,157 @@
 #include "meld/core/detail/filter_impl.hpp"
 
+#include <algorithm>
+#include <cassert>
+#include <ranges>
 #include <string>
+#include <utility>
 
 namespace {
   std::vector<meld::specified_label> const for_output_only{{"for_output_only"}};
 }
 
 namespace meld {
-  decision_map::decision_map(unsigned int total_decisions) : total_decisions_{total_decisions} {}
+  bool deferred_decision::result()
+  {
+    std::call_once(evaluated_, [this] { result_ = evaluate(); });
+    return result_;
+  }
 
-  void decision_map::update(predicate_result result)
+  filter_slot::filter_slot(std::size_t const nargs,
+                           unsigned int const total_decisions,
+                           unsigned int const deferred_decisions) :
+    remaining_{nargs + total_decisions},
+    claimed_{std::make_unique<std::atomic<bool>[]>(nargs)},
+    messages_(nargs),
+    deferred_(deferred_decisions)
   {
-    decltype(results_)::accessor a;
-    results_.insert(a, result.msg_id);
+  }
 
-    // First check that the decision is not already complete
-    if (is_complete(a->second)) {
-      return;
+  bool filter_slot::resolve()
+  {
+    if (not accepted()) {
+      return false;
     }
 
-    if (not result.result) {
-      a->second = false_value;
-      return;
+    std::vector<std::pair<double, deferred_decision*>> ordered;
+    ordered.reserve(n_deferred_.load(std::memory_order_relaxed));
+    for (auto const& decision : deferred_) {
+      if (decision) {
+        ordered.emplace_back(decision->cost_per_rejection(), decision.get());
+      }
     }
+    // Decisions of equal cost (e.g. those not yet measured) are evaluated in the order in
+    // which they were received.
+    std::ranges::stable_sort(ordered, {}, [](auto const& p) { return p.first; });
+
+    for (auto* decision : ordered | std::views::values) {
+      if (not decision->result()) {
+        rejected_.store(true, std::memory_order_relaxed);
+        return false;
+      }
+    }
+    return true;
+  }
 
-    ++a->second;
+  bool filter_slot::fill(message const& msg, specified_labels const product_names)
+  {
+    auto const nargs = size(messages_);
+    if (nargs == 1ull) {
+      // We do not check that the product is in the store if only one argument is
+      // forwarded.  This enables us to forward arguments for regular nodes and also
+      // output nodes, which do not take individual data products.
+      messages_[0] = msg;
+      return received_one();
+    }
 
-    if (a->second == total_decisions_) {
-      a->second = true_value;
+    // Fill slots in the order of the input arguments to the downstream node.
+    for (std::size_t i = 0; i != nargs; ++i) {
+      if (not msg.store->contains_product(product_names[i].name.full())) {
+        continue;
+      }
+      if (claimed_[i].exchange(true, std::memory_order_relaxed)) {
+        continue;
+      }
+      messages_[i] = msg;
     }
+    return received_one();
   }
 
-  unsigned int decision_map::value(std::size_t const msg_id) const
+  bool filter_slot::decide(predicate_result const& result)
   {
-    decltype(results_)::const_accessor a;
-    if (results_.find(a, msg_id)) {
-      return a->second;
+    if (result.deferred) {
+      auto const i = n_deferred_.fetch_add(1u, std::memory_order_relaxed);
+      assert(i < size(deferred_));
+      deferred_[i] = result.deferred;
+    }
+    else if (not result.result) {
+      rejected_.store(true, std::memory_order_relaxed);
     }
-    return 0u;
+    if (not eom_claimed_.exchange(true, std::memory_order_relaxed)) {
+      eom_ = result.eom;
+    }
+    return received_one();
   }
 
-  void decision_map::erase(std::size_t const msg_id) { results_.erase(msg_id); }
+  bool filter_slot::received_one() noexcept
+  {
+    // The release-acquire ordering makes the contents written by all updaters visible to
+    // the thread that completes the slot.
+    return remaining_.fetch_sub(1ull, std::memory_order_acq_rel) == 1ull;
+  }
 
-  data_map::data_map(specified_labels const product_names) :
-    product_names_{product_names}, nargs_{product_names_.size()}
+  filter_state::filter_state(unsigned int const total_decisions,
+                             for_output_t,
+                             unsigned int const deferred_decisions) :
+    filter_state{total_decisions, for_output_only, deferred_decisions}
   {
   }
 
-  data_map::data_map(for_output_t) : data_map{for_output_only} {}
+  filter_state::filter_state(unsigned int const total_decisions,
+                             specified_labels const product_names,
+                             unsigned int const deferred_decisions) :
+    total_decisions_{total_decisions},
+    deferred_decisions_{deferred_decisions},
+    product_names_{product_names}
+  {
+  }
 
-  void data_map::update(std::size_t const msg_id, product_store_const_ptr const& store)
+  std::unique_ptr<filter_slot> filter_state::update(message const& msg)
   {
-    decltype(stores_)::accessor a;
-    if (stores_.insert(a, msg_id)) {
-      a->second = std::vector<product_store_const_ptr>(nargs_);
-    }
-    auto& elem = a->second;
-    if (nargs_ == 1ull) {
-      // We do not check that the product is in the store if only one argument is
-      // forwarded.  This enables us to forward arguments for regular nodes and also
-      // output nodes, which do not take individual data products.
-      elem[0] = store;
-      return;
+    if (slot_for(msg.id).fill(msg, product_names_)) {
+      return release(msg.id);
     }
+    return nullptr;
+  }
 
-    // Fill slots in the order of the input arguments to the downstream node.
-    for (std::size_t i = 0; i != nargs_; ++i) {
-      if (elem[i] or not store->contains_product(product_names_[i].name.full()))
-        continue;
-      elem[i] = store;
+  std::unique_ptr<filter_slot> filter_state::update(predicate_result const& result)
+  {
+    if (slot_for(result.msg_id).decide(result)) {
+      return release(result.msg_id);
     }
+    return nullptr;
   }
 
-  bool data_map::is_complete(std::size_t const msg_id) const
+  filter_slot& filter_state::slot_for(std::size_t const msg_id)
   {
-    decltype(stores_)::const_accessor a;
-    if (stores_.find(a, msg_id)) {
-      return a->second.size() == nargs_;
+    // The slot is updated after the accessor has been released.  It remains valid because
+    // it is erased only by the thread that completes it, i.e. after all updates.
+    slots_t::const_accessor a;
+    if (not slots_.find(a, msg_id)) {
+      auto slot = std::make_unique<filter_slot>(
+        std::size(product_names_), total_decisions_, deferred_decisions_);
+      slots_.insert(a, {msg_id, std::move(slot)});
     }
-    return false;
+    return *a->second;
   }
 
-  std::vector<product_store_const_ptr> data_map::release_data(accessor& a, std::size_t const msg_id)
+  std::unique_ptr<filter_slot> filter_state::release(std::size_t const msg_id)
   {
-    std::vector<product_store_const_ptr> result;
-    if (stores_.find(a, msg_id)) {
-      result = std::move(a->second);
-      stores_.erase(a);
-    }
+    slots_t::accessor a;
+    [[maybe_unused]] bool const found = slots_.find(a, msg_id);
+    assert(found);
+    auto result = std::move(a->second);
+    slots_.erase(a);
     return result;
   }
 }
@@ -9,64 +9,102 @@
 #include "oneapi/tbb/concurrent_hash_map.h"
 #include "oneapi/tbb/flow_graph.h"
 
-#include <cassert>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
 #include <span>
+#include <vector>
 
 namespace meld {
+  // A predicate declared with on_demand() is not evaluated when its input messages arrive.
+  // It instead sends a deferred decision to the filters of its consumers, each of which
+  // evaluates it only if the consumer's other predicates have not already rejected the
+  // message.  The predicate is evaluated at most once per decision, and the result is
+  // shared by all filters that need it.
+  class deferred_decision {
+  public:
+    virtual ~deferred_decision() = default;
+
+    bool result();
+
+    // Filters evaluate their deferred decisions in ascending order of the expected
+    // evaluation cost per rejected message, as measured for the predicate so far.
+    virtual double cost_per_rejection() const = 0;
+
+  private:
+    virtual bool evaluate() = 0;
+
+    std::once_flag evaluated_;
+    bool result_{};
+  };
+
   struct predicate_result {
     end_of_message_ptr eom;
     std::size_t msg_id;
     bool result;
+    std::shared_ptr<deferred_decision> deferred{};
   };
 
-  inline constexpr unsigned int true_value{-1u};
-  inline constexpr unsigned int false_value{-2u};
-
-  constexpr bool is_complete(unsigned int value)
-  {
-    return value == true_value or value == false_value;
-  }
-
-  constexpr bool to_boolean(unsigned int value)
-  {
-    assert(is_complete(value));
-    return value == true_value;
-  }
-
-  class decision_map {
+  // The data messages and predicate results received by a filter for one message ID.  Each
+  // of them is recorded with atomic operations, and the slot is complete once all of them
+  // have been received.  Only the thread that completes the slot reads its contents.
+  class filter_slot {
   public:
-    explicit decision_map(unsigned int total_decisions);
+    filter_slot(std::size_t nargs, unsigned int total_decisions, unsigned int deferred_decisions);
+
+    bool accepted() const noexcept { return not rejected_.load(std::memory_order_relaxed); }
 
-    void update(predicate_result result);
-    unsigned int value(std::size_t msg_id) const;
-    void erase(std::size_t msg_id);
+    // Evaluates the deferred decisions of a complete slot until one of them rejects the
+    // message, returning whether the message has been accepted.
+    bool resolve();
+    end_of_message_ptr const& eom() const noexcept { return eom_; }
+    std::span<message const> messages() const noexcept { return messages_; }
 
   private:
-    unsigned int const total_decisions_;
-    oneapi::tbb::concurrent_hash_map<std::size_t, unsigned int> results_;
+    friend class filter_state;
+
+    // Returns true if the slot is complete after the update
+    bool fill(message const& msg, specified_labels product_names);
+    bool decide(predicate_result const& result);
+    bool received_one() noexcept;
+
+    std::atomic<std::size_t> remaining_;
+    std::atomic<bool> rejected_{false};
+    std::atomic<bool> eom_claimed_{false};
+    std::atomic<unsigned int> n_deferred_{};
+    end_of_message_ptr eom_{};
+    std::unique_ptr<std::atomic<bool>[]> claimed_;
+    std::vector<message> messages_;
+    std::vector<std::shared_ptr<deferred_decision>> deferred_;
   };
 
-  class data_map {
-    using stores_t =
-      oneapi::tbb::concurrent_hash_map<std::size_t, std::vector<product_store_const_ptr>>;
+  class filter_state {
+    using slots_t = oneapi::tbb::concurrent_hash_map<std::size_t, std::unique_ptr<filter_slot>>;
 
   public:
-    using accessor = stores_t::accessor;
-
     struct for_output_t {};
     static constexpr for_output_t for_output{};
-    explicit data_map(for_output_t);
-    explicit data_map(specified_labels product_names);
+    filter_state(unsigned int total_decisions, for_output_t, unsigned int deferred_decisions = 0);
+    filter_state(unsigned int total_decisions,
+                 specified_labels product_names,
+                 unsigned int deferred_decisions = 0);
 
-    bool is_complete(std::size_t const msg_id) const;
+    // Each update returns the slot if it has been completed by the update, in which case
+    // the slot is no longer owned by the filter state.
+    std::unique_ptr<filter_slot> update(message const& msg);
+    std::unique_ptr<filter_slot> update(predicate_result const& result);
 
-    void update(std::size_t const msg_id, product_store_const_ptr const& store);
-    std::vector<product_store_const_ptr> release_data(accessor& a, std::size_t const msg_id);
+    std::size_t size() const { return slots_.size(); }
 
   private:
-    stores_t stores_;
+    filter_slot& slot_for(std::size_t msg_id);
+    std::unique_ptr<filter_slot> release(std::size_t msg_id);
+
+    unsigned int const total_decisions_;
+    unsigned int const deferred_decisions_;
     specified_labels product_names_;
-    std::size_t nargs_;
+    slots_t slots_;
   };
 }
 
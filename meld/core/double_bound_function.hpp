@@ -6,6 +6,7 @@
 #include "meld/core/concepts.hpp"
 #include "meld/core/declared_monitor.hpp"
 #include "meld/core/declared_predicate.hpp"
+#include "meld/core/declared_splitter.hpp"
 #include "meld/core/declared_transform.hpp"
 #include "meld/core/input_arguments.hpp"
 #include "meld/core/node_catalog.hpp"
@@ -17,6 +18,7 @@
 #include <concepts>
 #include <functional>
 #include <memory>
+#include <tuple>
 
 namespace meld {
 
@@ -26,10 +28,11 @@ namespace meld {
     using node_options_t = node_options<double_bound_function<Object, Predicate, Unfold>>;
     using input_parameter_types = constructor_parameter_types<Object>;
     static_assert(
-      std::same_as<function_parameter_types<Predicate>, function_parameter_types<Unfold>>);
+      std::same_as<function_parameter_types<Predicate>, function_parameter_types<Unfold>> or
+      indexed_unfold<Object, Predicate, Unfold>);
 
   public:
-    static constexpr auto N = number_parameters<Predicate>;
+    static constexpr auto N = std::tuple_size_v<input_parameter_types>;
 
     double_bound_function(configuration const* config,
                           std::string name,
@@ -60,6 +63,7 @@ namespace meld {
         std::move(name_),
         concurrency_,
         node_options_t::release_predicates(),
+        nodes_.serializers_.get(node_options_t::release_resources()),
         graph_,
         std::move(predicate_),
         std::move(unfold_),
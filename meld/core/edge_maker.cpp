@@ -0,0 +1,62 @@
+#include "meld/core/edge_maker.hpp"
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace meld {
+
+  // Nodes whose inputs are all routed by the multiplexer can receive only the flush
+  // messages that pertain to them (see multiplexer::finalize).  Nodes downstream of a
+  // producer, however, receive whichever flush messages the producer forwards.  The
+  // producer must therefore forward the flush messages of all levels if a downstream node
+  // is a reduction (which requires the flush messages of its interval), or if the node's
+  // flush messages are assembled from more than one source.  Such producers, as well as
+  // their own producers, are not targeted.
+  multiplexer::nodes_t edge_maker::flush_targets(multiplexer::nodes_t const& nodes,
+                                                 multiplexer::nodes_t const& candidates) const
+  {
+    auto producers_of = [this](products_consumer const& node) {
+      std::vector<std::string> result;
+      for (auto const& product_label : node.input()) {
+        if (auto it = producers_.find(product_label.name.full("/")); it != cend(producers_)) {
+          result.push_back(it->second.node_name);
+        }
+      }
+      return result;
+    };
+
+    std::vector<std::string> to_visit;
+    for (auto const* node : nodes | std::views::values) {
+      auto producers = producers_of(*node);
+      if (empty(producers)) {
+        continue;
+      }
+      bool const mixed_inputs = size(producers) != node->num_inputs();
+      std::set<std::string> const distinct_producers(begin(producers), end(producers));
+      if (mixed_inputs or size(distinct_producers) > 1ull or not empty(node->flush_levels())) {
+        to_visit.insert(end(to_visit), begin(distinct_producers), end(distinct_producers));
+      }
+    }
+
+    std::set<std::string> forward_all;
+    while (not empty(to_visit)) {
+      auto name = std::move(to_visit.back());
+      to_visit.pop_back();
+      auto it = nodes.find(name);
+      if (not forward_all.insert(std::move(name)).second or it == cend(nodes)) {
+        continue;
+      }
+      auto producers = producers_of(*it->second);
+      to_visit.insert(end(to_visit), begin(producers), end(producers));
+    }
+
+    multiplexer::nodes_t result;
+    for (auto const& [name, node] : candidates) {
+      if (not forward_all.contains(name)) {
+        result.try_emplace(name, node);
+      }
+    }
+    return result;
+  }
+}
@@ -3,12 +3,15 @@
 
 #include "meld/core/declared_output.hpp"
 #include "meld/core/declared_splitter.hpp"
+#include "meld/core/declared_transform.hpp"
 #include "meld/core/dot/attributes.hpp"
 #include "meld/core/dot/data_graph.hpp"
 #include "meld/core/dot/function_graph.hpp"
 #include "meld/core/filter.hpp"
 #include "meld/core/multiplexer.hpp"
 
+#include <concepts>
+#include <cstddef>
 #include <map>
 #include <memory>
 #include <ranges>
@@ -45,7 +48,7 @@ namespace meld {
     edge_maker(std::string const& file_prefix, Args&... args);
 
     template <typename... Args>
-    void operator()(tbb::flow::input_node<message>& source,
+    void operator()(tbb::flow::sender<message>& source,
                     multiplexer& multi,
                     std::map<std::string, filter>& filters,
                     declared_outputs& outputs,
@@ -59,6 +62,7 @@ namespace meld {
       std::string node_name;
       tbb::flow::sender<message>* port;
       tbb::flow::sender<message>* to_output;
+      declared_transform* transform{nullptr};
     };
 
     template <typename T>
@@ -67,6 +71,12 @@ namespace meld {
     template <typename T>
     void record_attributes(T& consumers);
 
+    multiplexer::nodes_t flush_targets(multiplexer::nodes_t const& nodes,
+                                       multiplexer::nodes_t const& candidates) const;
+
+    template <typename T>
+    void count_consumers(T& consumers);
+
     template <typename T>
     multiplexer::head_ports_t edges(std::map<std::string, filter>& filters, T& consumers);
 
@@ -75,6 +85,7 @@ namespace meld {
 
     std::map<product_name_t, named_output_port> producers_;
     std::map<std::string, dot::attributes> attributes_;
+    std::map<std::string, std::size_t> consumer_counts_;
 
     template <typename T>
     void make_the_node(T& node, dot::attributes const& node_attributes)
@@ -111,6 +122,35 @@ namespace meld {
                                .label = dot::parenthesized(product_name)});
       }
     }
+
+    // A linear chain of transforms (the downstream transform is the only consumer of the
+    // upstream transform's products) is fused so that the upstream transform invokes the
+    // downstream one directly on the same thread, bypassing the flow-graph edge between
+    // them.  The transforms remain separate nodes for statistics and graph output.
+    template <typename Sender>
+    bool fuse_the_edge(Sender& sender,
+                       declared_transform& receiver,
+                       std::string const& receiver_node_name,
+                       std::string const& product_name)
+    {
+      // The receiver runs within the sender's body, so the sender must be unrestricted as
+      // well: it would otherwise hold its concurrency slot and resources for both.
+      if (not sender.transform or not sender.transform->unrestricted() or
+          not receiver.fusible() or consumer_counts_[sender.node_name] != 1ull) {
+        return false;
+      }
+
+      sender.transform->fuse(receiver);
+      if (function_graph_) {
+        function_graph_->edge(sender.node_name,
+                              receiver_node_name,
+                              {.color = "blue",
+                               .fontsize = dot::default_fontsize,
+                               .label = dot::parenthesized(product_name),
+                               .style = "bold"});
+      }
+      return true;
+    }
   };
 
   // =============================================================================
@@ -131,7 +171,11 @@ namespace meld {
       for (auto const& product_name : node->output()) {
         if (empty(product_name.name()))
           continue;
-        result[product_name.full("/")] = {node_name, &node->sender(), &node->to_output()};
+        named_output_port port{node_name, &node->sender(), &node->to_output()};
+        if constexpr (std::same_as<T, declared_transforms>) {
+          port.transform = node.get();
+        }
+        result[product_name.full("/")] = port;
       }
     }
     return result;
@@ -146,6 +190,18 @@ namespace meld {
     }
   }
 
+  template <typename T>
+  void edge_maker::count_consumers(T& consumers)
+  {
+    for (auto const& node : consumers.data | std::views::values) {
+      for (auto const& product_label : node->input()) {
+        if (auto it = producers_.find(product_label.name.full("/")); it != cend(producers_)) {
+          ++consumer_counts_[it->second.node_name];
+        }
+      }
+    }
+  }
+
   template <typename T>
   multiplexer::head_ports_t edge_maker::edges(std::map<std::string, filter>& filters, T& consumers)
   {
@@ -168,6 +224,12 @@ namespace meld {
           continue;
         }
 
+        if constexpr (std::same_as<T, meld::consumers<declared_transforms>>) {
+          if (not collector and
+              fuse_the_edge(it->second, *node, node_name, to_name(product_label))) {
+            continue;
+          }
+        }
         make_the_edge(it->second, *receiver_port, node_name, to_name(product_label));
       }
     }
@@ -175,7 +237,7 @@ namespace meld {
   }
 
   template <typename... Args>
-  void edge_maker::operator()(tbb::flow::input_node<message>& source,
+  void edge_maker::operator()(tbb::flow::sender<message>& source,
                               multiplexer& multi,
                               std::map<std::string, filter>& filters,
                               declared_outputs& outputs,
@@ -208,7 +270,8 @@ namespace meld {
       }
     }
 
-    // Create normal edges
+    // Create normal edges, fusing linear chains of transforms
+    (count_consumers(cons), ...);
     multiplexer::head_ports_t head_ports;
     (head_ports.merge(edges(filters, cons)), ...);
 
@@ -224,6 +287,41 @@ namespace meld {
     std::map<std::string, std::vector<std::string>> consumed_products;
     (get_consumed_products(cons, consumed_products), ...);
 
+    // Nodes without filters may receive their messages pre-assembled from a multiplexer.
+    multiplexer::nodes_t unfiltered_nodes;
+    auto get_unfiltered_nodes = [&filters, &unfiltered_nodes](auto const& cons) {
+      for (auto const& [key, consumer] : cons.data) {
+        if (not filters.contains(key)) {
+          unfiltered_nodes.try_emplace(key, consumer.get());
+        }
+      }
+    };
+    (get_unfiltered_nodes(cons), ...);
+
+    multiplexer::nodes_t all_nodes;
+    auto get_all_nodes = [&all_nodes](auto const& cons) {
+      for (auto const& [key, consumer] : cons.data) {
+        all_nodes.try_emplace(key, consumer.get());
+      }
+    };
+    (get_all_nodes(cons), ...);
+
+    // Each node is told how many nodes consume each of its input products.  Output nodes
+    // see all products, so they count as consumers of every product.
+    auto set_consumer_counts = [&consumed_products, &outputs](auto& cons) {
+      for (auto& consumer : cons.data | std::views::values) {
+        for (auto const& product_label : consumer->input()) {
+          consumer->set_consumer_count(product_label,
+                                       size(consumed_products[to_name(product_label)]) +
+                                         size(outputs));
+        }
+      }
+    };
+    (set_consumer_counts(cons), ...);
+    for (auto& output_node : outputs | std::views::values) {
+      output_node->set_consumer_counts(consumed_products, size(outputs));
+    }
+
     std::set<std::string> remove_ports_for_products;
     for (auto const& [name, splitter] : splitters.data) {
       multiplexer::head_ports_t heads;
@@ -239,7 +337,7 @@ namespace meld {
           }
         }
       }
-      splitter->finalize(std::move(heads));
+      splitter->finalize(std::move(heads), unfiltered_nodes);
     }
 
     // Remove head nodes claimed by splitters
@@ -250,7 +348,8 @@ namespace meld {
       }
     }
 
-    multi.finalize(std::move(head_ports));
+    multi.finalize(
+      std::move(head_ports), unfiltered_nodes, flush_targets(all_nodes, unfiltered_nodes));
 
     if (function_graph_) {
       for (auto const& [name, splitter] : splitters.data) {
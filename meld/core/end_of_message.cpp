@@ -1,23 +1,51 @@
 #include "meld/core/end_of_message.hpp"
+#include "meld/core/in_flight_limiter.hpp"
 #include "meld/model/level_hierarchy.hpp"
+#include "meld/model/level_id.hpp"
 
 namespace meld {
 
   end_of_message::end_of_message(end_of_message_ptr parent,
                                  level_hierarchy* hierarchy,
-                                 level_id_ptr id) :
-    parent_{parent}, hierarchy_{hierarchy}, id_{id}
+                                 level_id_ptr id,
+                                 in_flight_limiter* limiter,
+                                 std::shared_ptr<void> ticket,
+                                 std::size_t const message_id) :
+    parent_{parent},
+    hierarchy_{hierarchy},
+    id_{id},
+    limiter_{limiter},
+    ticket_{std::move(ticket)},
+    message_id_{message_id}
   {
   }
 
-  end_of_message_ptr end_of_message::make_base(level_hierarchy* hierarchy, level_id_ptr id)
+  end_of_message_ptr end_of_message::make_base(level_hierarchy* hierarchy,
+                                               level_id_ptr id,
+                                               in_flight_limiter* limiter,
+                                               std::size_t const message_id)
   {
-    return end_of_message_ptr{new end_of_message{nullptr, hierarchy, id}};
+    return end_of_message_ptr{
+      new end_of_message{nullptr, hierarchy, id, limiter, nullptr, message_id}};
   }
 
-  end_of_message_ptr end_of_message::make_child(level_id_ptr id)
+  end_of_message_ptr end_of_message::make_child(level_id_ptr id,
+                                                in_flight_limiter* limiter,
+                                                std::shared_ptr<void> ticket,
+                                                std::size_t const message_id)
   {
-    return end_of_message_ptr{new end_of_message{shared_from_this(), hierarchy_, id}};
+    return end_of_message_ptr{new end_of_message{
+      shared_from_this(), hierarchy_, std::move(id), limiter, std::move(ticket), message_id}};
+  }
+
+  std::size_t end_of_message::message_id_for(level_id const& id) const
+  {
+    for (auto const* current = this; current != nullptr; current = current->parent_.get()) {
+      if (current->id_->hash() == id.hash()) {
+        return current->message_id_;
+      }
+    }
+    return -1ull;
   }
 
   end_of_message::~end_of_message()
@@ -25,6 +53,9 @@ namespace meld {
     if (hierarchy_) {
       hierarchy_->increment_count(id_);
     }
+    if (limiter_) {
+      limiter_->release(*id_);
+    }
   }
 
 }
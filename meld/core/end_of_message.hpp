@@ -4,22 +4,43 @@
 #include "meld/core/fwd.hpp"
 #include "meld/model/fwd.hpp"
 
+#include <cstddef>
 #include <memory>
 
 namespace meld {
 
   class end_of_message : public std::enable_shared_from_this<end_of_message> {
   public:
-    static end_of_message_ptr make_base(level_hierarchy* hierarchy, level_id_ptr id);
-    end_of_message_ptr make_child(level_id_ptr id);
+    static end_of_message_ptr make_base(level_hierarchy* hierarchy,
+                                        level_id_ptr id,
+                                        in_flight_limiter* limiter = nullptr,
+                                        std::size_t message_id = -1ull);
+    // The ticket (if any) is destroyed together with the child, which allows the creator of
+    // the child to be notified once the child has been fully processed.
+    end_of_message_ptr make_child(level_id_ptr id,
+                                  in_flight_limiter* limiter = nullptr,
+                                  std::shared_ptr<void> ticket = nullptr,
+                                  std::size_t message_id = -1ull);
     ~end_of_message();
 
+    // The ID of the message that introduced the given level instance, which must be this
+    // message's or one of its ancestors' (-1 if the ID was not recorded)
+    std::size_t message_id_for(level_id const& id) const;
+
   private:
-    end_of_message(end_of_message_ptr parent, level_hierarchy* hierarchy, level_id_ptr id);
+    end_of_message(end_of_message_ptr parent,
+                   level_hierarchy* hierarchy,
+                   level_id_ptr id,
+                   in_flight_limiter* limiter,
+                   std::shared_ptr<void> ticket = nullptr,
+                   std::size_t message_id = -1ull);
 
     end_of_message_ptr parent_;
     level_hierarchy* hierarchy_;
     level_id_ptr id_;
+    in_flight_limiter* limiter_;
+    std::shared_ptr<void> ticket_;
+    std::size_t message_id_;
   };
 
 }
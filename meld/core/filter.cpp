@@ -8,28 +8,34 @@ using namespace meld;
 using namespace oneapi::tbb;
 
 namespace meld {
-  filter::filter(flow::graph& g, products_consumer& consumer) :
+  filter::filter(flow::graph& g,
+                 products_consumer& consumer,
+                 unsigned int const deferred_decisions) :
     filter_base{g},
-    decisions_{static_cast<unsigned int>(consumer.when().size())},
-    data_{consumer.input()},
+    state_{static_cast<unsigned int>(consumer.when().size()),
+           consumer.input(),
+           deferred_decisions},
     indexer_{g},
     filter_{g, flow::unlimited, [this](tag_t const& t) { return execute(t); }},
     downstream_ports_{consumer.ports()},
-    nargs_{size(downstream_ports_)}
+    nargs_{size(downstream_ports_)},
+    trace_name_{trace::register_name(consumer.full_name())}
   {
     make_edge(indexer_, filter_);
     set_external_ports(input_ports_type{input_port<0>(indexer_), input_port<1>(indexer_)},
                        output_ports_type{filter_});
   }
 
-  filter::filter(flow::graph& g, declared_output& output) :
+  filter::filter(flow::graph& g, declared_output& output, unsigned int const deferred_decisions) :
     filter_base{g},
-    decisions_{static_cast<unsigned int>(output.when().size())},
-    data_{data_map::for_output},
+    state_{static_cast<unsigned int>(output.when().size()),
+           filter_state::for_output,
+           deferred_decisions},
     indexer_{g},
     filter_{g, flow::unlimited, [this](tag_t const& t) { return execute(t); }},
     downstream_ports_{&output.port()},
-    nargs_{size(downstream_ports_)}
+    nargs_{size(downstream_ports_)},
+    trace_name_{trace::register_name(output.full_name())}
   {
     make_edge(indexer_, filter_);
     set_external_ports(input_ports_type{input_port<0>(indexer_), input_port<1>(indexer_)},
@@ -38,14 +44,10 @@ namespace meld {
 
   flow::continue_msg filter::execute(tag_t const& t)
   {
-    // FIXME: This implementation is horrible!  Because there are two data structures that
-    //        have to work together.
-    end_of_message_ptr eom{};
-    unsigned int msg_id{};
+    trace::scope const trace{trace::category::filter, trace_name_};
+    std::unique_ptr<filter_slot> slot;
     if (t.is_a<message>()) {
       auto const& msg = t.cast_to<message>();
-      data_.update(msg.id, msg.store);
-      msg_id = msg.id;
       if (msg.store->is_flush()) {
         // All flush messages are automatically forwarded to downstream ports.
         for (std::size_t i = 0ull; i != nargs_; ++i) {
@@ -53,35 +55,24 @@ namespace meld {
         }
         return {};
       }
+      slot = state_.update(msg);
     }
     else {
-      auto const& result = t.cast_to<predicate_result>();
-      decisions_.update(result);
-      eom = result.eom;
-      msg_id = result.msg_id;
+      slot = state_.update(t.cast_to<predicate_result>());
     }
 
-    auto const filter_decision = decisions_.value(msg_id);
-    if (not is_complete(filter_decision)) {
+    // The slot is returned exactly once, when all data messages and predicate results for
+    // its message ID have been received.  Deferred decisions are evaluated only if the
+    // message has not already been rejected.
+    if (not slot or not slot->resolve()) {
       return {};
     }
 
-    if (not data_.is_complete(msg_id)) {
-      return {};
-    }
-
-    if (to_boolean(filter_decision)) {
-      // FIXME: Can we get rid of this awful accessor?
-      data_map::accessor a;
-      auto const stores = data_.release_data(a, msg_id);
-      if (empty(stores)) {
-        return {};
-      }
-      for (std::size_t i = 0ull; i != nargs_; ++i) {
-        downstream_ports_[i]->try_put({stores[i], eom, msg_id});
-      }
+    auto const messages = slot->messages();
+    for (std::size_t i = 0ull; i != nargs_; ++i) {
+      downstream_ports_[i]->try_put(
+        {messages[i].store, slot->eom(), messages[i].id, -1ull, messages[i].redelivered});
     }
-    decisions_.erase(msg_id);
     return {};
   }
 }
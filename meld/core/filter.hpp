@@ -4,6 +4,7 @@
 #include "meld/core/detail/filter_impl.hpp"
 #include "meld/core/fwd.hpp"
 #include "meld/core/message.hpp"
+#include "meld/utilities/tracer.hpp"
 
 #include "oneapi/tbb/flow_graph.h"
 
@@ -20,8 +21,13 @@ namespace meld {
     using filter_base::input_ports_type;
     using filter_base::output_ports_type;
 
-    explicit filter(oneapi::tbb::flow::graph& g, products_consumer& consumer);
-    explicit filter(oneapi::tbb::flow::graph& g, declared_output& output);
+    // The deferred decisions are those of the on-demand predicates (see declared_predicate).
+    filter(oneapi::tbb::flow::graph& g,
+           products_consumer& consumer,
+           unsigned int deferred_decisions = 0);
+    filter(oneapi::tbb::flow::graph& g,
+           declared_output& output,
+           unsigned int deferred_decisions = 0);
 
     auto& data_port() { return input_port<0>(*this); }
     auto& predicate_port() { return input_port<1>(*this); }
@@ -29,12 +35,12 @@ namespace meld {
   private:
     oneapi::tbb::flow::continue_msg execute(tag_t const& tag);
 
-    decision_map decisions_;
-    data_map data_;
+    filter_state state_;
     indexer_t indexer_;
     oneapi::tbb::flow::function_node<tag_t> filter_;
     std::vector<oneapi::tbb::flow::receiver<message>*> downstream_ports_;
     std::size_t nargs_;
+    trace::name_t trace_name_;
   };
 }
 
@@ -16,7 +16,7 @@ namespace meld {
                              product_store_ptr store) :
     counters_{counters}, sender_{sender}, store_{store}, depth_{store_->id()->depth()}
   {
-    counters_.update(store_->id());
+    counters_.update(store_->id(), store_->declared_child_counts());
   }
 
   level_sentry::~level_sentry()
@@ -32,26 +32,35 @@ namespace meld {
 
   std::size_t level_sentry::depth() const noexcept { return depth_; }
 
-  framework_graph::framework_graph(product_store_ptr store, int const max_parallelism) :
+  framework_graph::framework_graph(product_store_ptr store,
+                                   int const max_parallelism,
+                                   in_flight_limits const& max_in_flight) :
     framework_graph{[store](cached_product_stores&) mutable {
                       // Returns non-null store, then replaces it with nullptr, thus
                       // resulting in one graph execution.
                       return std::exchange(store, nullptr);
                     },
-                    max_parallelism}
+                    max_parallelism,
+                    max_in_flight}
   {
   }
 
   framework_graph::framework_graph(std::function<product_store_ptr()> f,
-                                   int const max_parallelism) :
+                                   int const max_parallelism,
+                                   in_flight_limits const& max_in_flight) :
     framework_graph{[ft = std::move(f)](cached_product_stores&) mutable { return ft(); },
-                    max_parallelism}
+                    max_parallelism,
+                    max_in_flight}
   {
   }
 
   // FIXME: The algorithm below should support user-specified flush stores.
-  framework_graph::framework_graph(detail::next_store_t next_store, int const max_parallelism) :
+  framework_graph::framework_graph(detail::next_store_t next_store,
+                                   int const max_parallelism,
+                                   in_flight_limits const& max_in_flight) :
     parallelism_limit_{static_cast<std::size_t>(max_parallelism)},
+    limiter_{empty(max_in_flight) ? nullptr
+                                  : std::make_unique<in_flight_limiter>(graph_, max_in_flight)},
     src_{graph_,
          [this, read_next = std::move(next_store)](tbb::flow_control& fc) mutable -> message {
            auto store = read_next(stores_);
@@ -72,9 +81,19 @@ namespace meld {
 
     // The parent of the job message is null
     eoms_.push(nullptr);
+
+    if (limiter_) {
+      make_edge(src_, limiter_->input());
+    }
   }
 
-  framework_graph::~framework_graph() = default;
+  framework_graph::~framework_graph()
+  {
+    // Tasks spawned by the graph refer to its nodes, which are destroyed before the graph
+    // itself.  The tasks must therefore be completed first, which matters if the graph has
+    // never been executed (e.g. due to registration errors).
+    graph_.wait_for_all();
+  }
 
   std::size_t framework_graph::execution_counts(std::string const& node_name) const
   {
@@ -112,6 +131,23 @@ namespace meld {
     return 0u;
   }
 
+  std::map<std::string, execution_summary> framework_graph::node_statistics() const
+  {
+    std::map<std::string, execution_summary> result;
+    auto collect = [&result](auto const& nodes) {
+      for (auto const& [name, node] : nodes) {
+        result.try_emplace(name, node->statistics());
+      }
+    };
+    collect(nodes_.predicates_);
+    collect(nodes_.monitors_);
+    collect(nodes_.outputs_);
+    collect(nodes_.reductions_);
+    collect(nodes_.splitters_);
+    collect(nodes_.transforms_);
+    return result;
+  }
+
   void framework_graph::execute(std::string const& dot_file_prefix)
   {
     finalize(dot_file_prefix);
@@ -119,10 +155,54 @@ namespace meld {
     // post_data_graph(dot_file_prefix);
   }
 
+  void framework_graph::declare_resource(std::string const& name, std::size_t const tokens)
+  {
+    if (tokens == 0ull) {
+      throw std::runtime_error("The number of tokens for resource '" + name +
+                               "' must be greater than zero.");
+    }
+    nodes_.serializers_.get(name).set_tokens(tokens);
+  }
+
   void framework_graph::run()
   {
+    nodes_.serializers_.activate();
     src_.activate();
     graph_.wait_for_all();
+    if (execution_statistics_enabled()) {
+      report_statistics();
+    }
+  }
+
+  void framework_graph::report_statistics() const
+  {
+    auto const statistics = node_statistics();
+    if (empty(statistics)) {
+      return;
+    }
+
+    auto to_ms = [](std::chrono::nanoseconds const t) { return t.count() / 1e6; };
+    std::string report{fmt::format("{:<40}{:>10}{:>12}{:>12}{:>10}{:>10}{:>10}{:>10}",
+                                   "Node",
+                                   "Calls",
+                                   "Wall [ms]",
+                                   "CPU [ms]",
+                                   "Min [ms]",
+                                   "p50 [ms]",
+                                   "p99 [ms]",
+                                   "Max [ms]")};
+    for (auto const& [name, s] : statistics) {
+      report += fmt::format("\n{:<40}{:>10}{:>12.3f}{:>12.3f}{:>10.3f}{:>10.3f}{:>10.3f}{:>10.3f}",
+                            name,
+                            s.count,
+                            to_ms(s.total_wall),
+                            to_ms(s.total_cpu),
+                            to_ms(s.min_wall),
+                            to_ms(s.p50_wall),
+                            to_ms(s.p99_wall),
+                            to_ms(s.max_wall));
+    }
+    spdlog::info("Node execution statistics:\n\n{}\n", report);
   }
 
   namespace {
@@ -138,14 +218,21 @@ namespace meld {
           continue;
         }
 
-        auto [it, success] = result.try_emplace(name, g, *consumer);
+        std::vector<declared_predicate*> guards;
+        unsigned int deferred_decisions{};
         for (auto const& predicate_name : predicates) {
           auto fit = all_predicates.find(predicate_name);
           if (fit == cend(all_predicates)) {
             throw std::runtime_error("A non-existent filter with the name '" + predicate_name +
                                      "' was specified for " + name);
           }
-          make_edge(fit->second->sender(), it->second.predicate_port());
+          guards.push_back(fit->second.get());
+          deferred_decisions += fit->second->on_demand();
+        }
+
+        auto [it, success] = result.try_emplace(name, g, *consumer, deferred_decisions);
+        for (auto* guard : guards) {
+          make_edge(guard->sender(), it->second.predicate_port());
         }
       }
       return result;
@@ -170,7 +257,7 @@ namespace meld {
     filters_.merge(internal_edges_for_predicates(graph_, nodes_.predicates_, nodes_.transforms_));
 
     edge_maker make_edges{dot_file_prefix, nodes_.transforms_, nodes_.reductions_};
-    make_edges(src_,
+    make_edges(limiter_ ? limiter_->output() : src_,
                multiplexer_,
                filters_,
                nodes_.outputs_,
@@ -9,6 +9,7 @@
 #include "meld/core/filter.hpp"
 #include "meld/core/glue.hpp"
 #include "meld/core/graph_proxy.hpp"
+#include "meld/core/in_flight_limiter.hpp"
 #include "meld/core/message.hpp"
 #include "meld/core/message_sender.hpp"
 #include "meld/core/multiplexer.hpp"
@@ -16,6 +17,7 @@
 #include "meld/model/level_hierarchy.hpp"
 #include "meld/model/product_store.hpp"
 #include "meld/source.hpp"
+#include "meld/utilities/execution_statistics.hpp"
 #include "meld/utilities/resource_usage.hpp"
 
 #include "oneapi/tbb/flow_graph.h"
@@ -23,6 +25,7 @@
 
 #include <functional>
 #include <map>
+#include <memory>
 #include <queue>
 #include <stack>
 #include <string>
@@ -48,17 +51,26 @@ namespace meld {
   class framework_graph {
   public:
     explicit framework_graph(product_store_ptr store,
-                             int max_parallelism = oneapi::tbb::info::default_concurrency());
+                             int max_parallelism = oneapi::tbb::info::default_concurrency(),
+                             in_flight_limits const& max_in_flight = {});
     explicit framework_graph(std::function<product_store_ptr()> f,
-                             int max_parallelism = oneapi::tbb::info::default_concurrency());
+                             int max_parallelism = oneapi::tbb::info::default_concurrency(),
+                             in_flight_limits const& max_in_flight = {});
     explicit framework_graph(detail::next_store_t f,
-                             int max_parallelism = oneapi::tbb::info::default_concurrency());
+                             int max_parallelism = oneapi::tbb::info::default_concurrency(),
+                             in_flight_limits const& max_in_flight = {});
     ~framework_graph();
 
     void execute(std::string const& dot_prefix = {});
 
     std::size_t execution_counts(std::string const& node_name) const;
     std::size_t product_counts(std::string const& node_name) const;
+    std::map<std::string, execution_summary> node_statistics() const;
+
+    // Nodes using the named resource (see node_options::using_resources) may execute
+    // concurrently as long as no more than the specified number of them do so.  A
+    // resource that is not declared allows only one node to use it at a time.
+    void declare_resource(std::string const& name, std::size_t tokens);
 
     graph_proxy<void_tag> proxy(configuration const& config)
     {
@@ -80,18 +92,25 @@ namespace meld {
     {
       return unfold_proxy<T>().declare_unfold(predicate, unfold, c);
     }
+    template <typename T>
+    auto with(auto unfold, concurrency c = concurrency::serial)
+      requires lazy_unfold<T, decltype(unfold)>
+    {
+      return unfold_proxy<T>().declare_unfold(unfold, c);
+    }
 
     template <typename T, typename... Args>
     glue<T> make(Args&&... args)
     {
       return {
-        graph_, nodes_, std::make_shared<T>(std::forward<Args>(args)...), registration_errors_};
+        graph_, nodes_, make_instance_source<T>(std::forward<Args>(args)...), registration_errors_};
     }
 
   private:
     void run();
     void finalize(std::string const& dot_file_prefix);
     void post_data_graph(std::string const& dot_file_prefix);
+    void report_statistics() const;
 
     product_store_ptr accept(product_store_ptr store);
     void drain();
@@ -109,14 +128,15 @@ namespace meld {
     concurrency::max_allowed_parallelism parallelism_limit_;
     tbb::flow::graph graph_{};
     level_hierarchy hierarchy_{};
-    node_catalog nodes_{};
+    node_catalog nodes_{graph_};
     cached_product_stores stores_{};
     std::vector<std::string> registration_errors_{};
     std::map<std::string, filter> filters_{};
+    std::unique_ptr<in_flight_limiter> limiter_;
     tbb::flow::input_node<message> src_;
     multiplexer multiplexer_;
     std::stack<end_of_message_ptr> eoms_;
-    message_sender sender_{hierarchy_, multiplexer_, eoms_};
+    message_sender sender_{hierarchy_, multiplexer_, eoms_, limiter_.get()};
     std::queue<product_store_ptr> pending_stores_;
     flush_counters counters_;
     std::stack<level_sentry> levels_;
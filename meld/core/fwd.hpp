@@ -9,6 +9,7 @@ namespace meld {
   class declared_output;
   class end_of_message;
   class generator;
+  class in_flight_limiter;
   class framework_graph;
   class message_sender;
   class multiplexer;
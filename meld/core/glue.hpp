@@ -7,15 +7,18 @@
 #include "meld/core/double_bound_function.hpp"
 #include "meld/core/node_catalog.hpp"
 #include "meld/core/registrar.hpp"
+#include "meld/core/replicas.hpp"
 #include "meld/metaprogramming/delegate.hpp"
 #include "meld/metaprogramming/function_name.hpp"
 
 #include "oneapi/tbb/flow_graph.h"
+#include "spdlog/spdlog.h"
 
 #include <memory>
 #include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 namespace meld {
 
@@ -27,28 +30,55 @@ namespace meld {
   public:
     glue(tbb::flow::graph& g,
          node_catalog& nodes,
-         std::shared_ptr<T> bound_obj,
+         std::shared_ptr<instance_source<T>> source,
          std::vector<std::string>& errors,
-         configuration const* config = nullptr) :
-      graph_{g}, nodes_{nodes}, bound_obj_{std::move(bound_obj)}, errors_{errors}, config_{config}
+         configuration const* config = nullptr,
+         std::shared_ptr<replicas<T>> bound_replicas = nullptr) :
+      graph_{g},
+      nodes_{nodes},
+      source_{std::move(source)},
+      errors_{errors},
+      config_{config},
+      replicas_{std::move(bound_replicas)}
     {
     }
 
+    // Each node subsequently registered for the bound object may be executed
+    // concurrently by up to n threads, each using its own instance of the object.
+    glue& replicated(std::size_t const n)
+      requires(not std::same_as<T, void_tag>)
+    {
+      replicas_ = make_replicas(*source_, n, nodes_.serializers_, errors_);
+      return *this;
+    }
+
     auto with(std::string name, auto f, concurrency c = concurrency::serial)
     {
-      return bound_function{config_, std::move(name), bound_obj_, f, c, graph_, nodes_, errors_};
+      auto const node_concurrency = effective(name, c);
+      return bound_function{config_,
+                            std::move(name),
+                            bound_obj(),
+                            f,
+                            node_concurrency,
+                            graph_,
+                            nodes_,
+                            errors_,
+                            replicas_};
     }
 
     auto with(auto f, concurrency c = concurrency::serial) { return with(function_name(f), f, c); }
 
     auto output_with(std::string name, is_output_like auto f, concurrency c = concurrency::serial)
     {
+      auto const node_concurrency = effective(name, c);
       return output_creator{nodes_.register_output(errors_),
                             config_,
                             std::move(name),
                             graph_,
-                            delegate(bound_obj_, f),
-                            c};
+                            nodes_.serializers_,
+                            output_delegate(f),
+                            node_concurrency,
+                            replicas_resource()};
     }
     auto output_with(is_output_like auto f, concurrency c = concurrency::serial)
     {
@@ -56,11 +86,76 @@ namespace meld {
     }
 
   private:
+    // A replicated object is invoked by at most as many threads as there are replicas.  A
+    // node registered for it with the default (serial) concurrency may use all of them; a
+    // larger concurrency cannot be granted.
+    concurrency effective(std::string const& name, concurrency const c) const
+    {
+      if (not replicas_) {
+        return c;
+      }
+      auto const n = replicas_->size();
+      if (c.value == concurrency::serial.value) {
+        return concurrency{n};
+      }
+      if (c.value == concurrency::unlimited.value) {
+        spdlog::warn("Node '{}' is registered with unlimited concurrency, but its object has "
+                     "only {} replicas; the concurrency is reduced to {}.",
+                     name,
+                     n,
+                     n);
+        return concurrency{n};
+      }
+      if (c.value > n) {
+        spdlog::warn("Node '{}' is registered with a concurrency of {}, but its object has only "
+                     "{} replicas; the concurrency is reduced to {}.",
+                     name,
+                     c.value,
+                     n,
+                     n);
+        return concurrency{n};
+      }
+      return c;
+    }
+
+    std::vector<std::string> replicas_resource() const
+    {
+      if constexpr (not std::same_as<T, void_tag>) {
+        if (replicas_) {
+          return {replicas_->resource_name()};
+        }
+      }
+      return {};
+    }
+
+    // The bound object is constructed only if it has not been replicated.
+    std::shared_ptr<T> bound_obj()
+    {
+      if constexpr (not std::same_as<T, void_tag>) {
+        if (not replicas_) {
+          return source_->instance();
+        }
+      }
+      return nullptr;
+    }
+
+    auto output_delegate(auto f)
+    {
+      if constexpr (not std::same_as<T, void_tag>) {
+        if (replicas_) {
+          return delegate(replicas_, f);
+        }
+      }
+      auto obj = bound_obj();
+      return delegate(obj, f);
+    }
+
     tbb::flow::graph& graph_;
     node_catalog& nodes_;
-    std::shared_ptr<T> bound_obj_;
+    std::shared_ptr<instance_source<T>> source_;
     std::vector<std::string>& errors_;
     configuration const* config_;
+    std::shared_ptr<replicas<T>> replicas_;
   };
 
   template <typename T>
@@ -87,6 +182,9 @@ namespace meld {
         errors_};
     }
 
+    // The coroutine of a lazy unfold serves as both its predicate and its unfold function.
+    auto declare_unfold(auto unfold, concurrency c) { return declare_unfold(unfold, unfold, c); }
+
   private:
     tbb::flow::graph& graph_;
     node_catalog& nodes_;
@@ -7,6 +7,7 @@
 #include "meld/core/glue.hpp"
 #include "meld/core/node_catalog.hpp"
 #include "meld/core/registrar.hpp"
+#include "meld/core/replicas.hpp"
 #include "meld/metaprogramming/delegate.hpp"
 #include "meld/metaprogramming/function_name.hpp"
 
@@ -42,13 +43,24 @@ namespace meld {
     template <typename U, typename... Args>
     graph_proxy<U> make(Args&&... args)
     {
-      return graph_proxy<U>{
-        config_, graph_, nodes_, std::make_shared<U>(std::forward<Args>(args)...), errors_};
+      graph_proxy<U> result{
+        config_, graph_, nodes_, make_instance_source<U>(std::forward<Args>(args)...), errors_};
+      if (auto const n = config_->get_if_present<std::size_t>("replicas")) {
+        result.replicated(*n);
+      }
+      return result;
+    }
+
+    graph_proxy& replicated(std::size_t const n)
+      requires(not std::same_as<T, void_tag>)
+    {
+      replicas_ = make_replicas(*source_, n, nodes_.serializers_, errors_);
+      return *this;
     }
 
     auto with(std::string name, auto f, concurrency c = concurrency::serial)
     {
-      return glue{graph_, nodes_, bound_obj_, errors_, config_}.with(name, f, c);
+      return to_glue().with(name, f, c);
     }
 
     auto with(auto f, concurrency c = concurrency::serial) { return with(function_name(f), f, c); }
@@ -59,10 +71,16 @@ namespace meld {
       return splitter_glue<Splitter>(graph_, nodes_, errors_).declare_unfold(predicate, unfold, c);
     }
 
+    template <typename Splitter>
+    auto with(auto unfold, concurrency c = concurrency::serial)
+      requires lazy_unfold<Splitter, decltype(unfold)>
+    {
+      return splitter_glue<Splitter>(graph_, nodes_, errors_).declare_unfold(unfold, c);
+    }
+
     auto output_with(std::string name, is_output_like auto f, concurrency c = concurrency::serial)
     {
-      return output_creator{
-        nodes_.register_output(errors_), config_, name, graph_, delegate(bound_obj_, f), c};
+      return to_glue().output_with(name, f, c);
     }
     auto output_with(is_output_like auto f, concurrency c = concurrency::serial)
     {
@@ -73,17 +91,20 @@ namespace meld {
     graph_proxy(configuration const* config,
                 tbb::flow::graph& g,
                 node_catalog& nodes,
-                std::shared_ptr<T> bound_obj,
+                std::shared_ptr<instance_source<T>> source,
                 std::vector<std::string>& errors)
       requires(not std::same_as<T, void_tag>)
-      : config_{config}, graph_{g}, nodes_{nodes}, bound_obj_{bound_obj}, errors_{errors}
+      : config_{config}, graph_{g}, nodes_{nodes}, source_{std::move(source)}, errors_{errors}
     {
     }
 
+    glue<T> to_glue() { return {graph_, nodes_, source_, errors_, config_, replicas_}; }
+
     configuration const* config_;
     tbb::flow::graph& graph_;
     node_catalog& nodes_;
-    std::shared_ptr<T> bound_obj_;
+    std::shared_ptr<instance_source<T>> source_;
+    std::shared_ptr<replicas<T>> replicas_;
     std::vector<std::string>& errors_;
   };
 }
@@ -0,0 +1,74 @@
+#include "meld/core/in_flight_limiter.hpp"
+#include "meld/model/level_id.hpp"
+#include "meld/model/product_store.hpp"
+
+#include <stdexcept>
+
+namespace meld {
+  in_flight_limiter::in_flight_limiter(tbb::flow::graph& g, in_flight_limits const& limits) :
+    limiter_{g, 1}, gate_{g, tbb::flow::unlimited, [this](message const& msg) {
+                            admit(msg);
+                            return tbb::flow::continue_msg{};
+                          }},
+    admitted_{g}
+  {
+    for (auto const& [level_name, max] : limits) {
+      if (max == 0ull) {
+        throw std::runtime_error("The maximum number of in-flight stores for level '" +
+                                 level_name + "' must be greater than zero.");
+      }
+      entries_.try_emplace(level_name, level_entry{max});
+    }
+    make_edge(limiter_, gate_);
+  }
+
+  tbb::flow::receiver<message>& in_flight_limiter::input() noexcept { return limiter_; }
+  tbb::flow::sender<message>& in_flight_limiter::output() noexcept { return admitted_; }
+
+  auto in_flight_limiter::entry_for(level_id const& id) -> level_entry*
+  {
+    if (auto it = entries_.find(id.level_name()); it != entries_.end()) {
+      return &it->second;
+    }
+    return nullptr;
+  }
+
+  void in_flight_limiter::admit(message const& msg)
+  {
+    if (auto* entry = entry_for(*msg.store->id())) {
+      tbb::spin_mutex::scoped_lock lock{mutex_};
+      if (entry->live == entry->max) {
+        held_ = msg;
+        return;
+      }
+      ++entry->live;
+    }
+    forward(msg);
+  }
+
+  void in_flight_limiter::release(level_id const& id)
+  {
+    auto* entry = entry_for(id);
+    if (not entry) {
+      return;
+    }
+
+    std::optional<message> msg;
+    {
+      tbb::spin_mutex::scoped_lock lock{mutex_};
+      --entry->live;
+      if (not held_ or entry_for(*held_->store->id()) != entry) {
+        return;
+      }
+      ++entry->live;
+      msg = std::exchange(held_, std::nullopt);
+    }
+    forward(*msg);
+  }
+
+  void in_flight_limiter::forward(message const& msg)
+  {
+    admitted_.try_put(msg);
+    limiter_.decrementer().try_put(tbb::flow::continue_msg{});
+  }
+}
@@ -0,0 +1,69 @@
+#ifndef meld_core_in_flight_limiter_hpp
+#define meld_core_in_flight_limiter_hpp
+
+// =======================================================================================
+// The in_flight_limiter bounds the number of stores per level that are concurrently live
+// in the graph.  A store read from the source is admitted (i.e. forwarded to the
+// downstream nodes) only if fewer than the configured maximum number of stores for its
+// level are live.  A store is considered live from the time it is admitted until the
+// end_of_message object created for it is destroyed.
+//
+// The limiter is placed between the source node and the rest of the graph:
+//
+//    source -> limiter_ (threshold of 1) -> gate_ ... admitted_ -> multiplexer, outputs
+//
+// Each message passing through the limiter_ node is examined by the gate_.  If the
+// message can be admitted, the gate_ forwards it to the admitted_ node and decrements the
+// limiter_, thus permitting the source to read the next store.  Otherwise, the message
+// is held and the limiter_ is not decremented, so the source is blocked from reading any
+// further stores.  The held message is admitted whenever a store of the same level is
+// released.
+//
+// Because the source cannot read a new store of a given level until the previous one of
+// that level has been admitted, levels that are not configured with a limit are
+// effectively throttled by the limited levels beneath them.
+// =======================================================================================
+
+#include "meld/core/message.hpp"
+#include "meld/model/fwd.hpp"
+
+#include "oneapi/tbb/flow_graph.h"
+#include "oneapi/tbb/spin_mutex.h"
+
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <string>
+
+namespace meld {
+  using in_flight_limits = std::map<std::string, std::size_t>;
+
+  class in_flight_limiter {
+  public:
+    in_flight_limiter(tbb::flow::graph& g, in_flight_limits const& limits);
+
+    tbb::flow::receiver<message>& input() noexcept;
+    tbb::flow::sender<message>& output() noexcept;
+
+    void release(level_id const& id);
+
+  private:
+    struct level_entry {
+      std::size_t max;
+      std::size_t live{};
+    };
+
+    level_entry* entry_for(level_id const& id);
+    void admit(message const& msg);
+    void forward(message const& msg);
+
+    std::map<std::string, level_entry> entries_;
+    tbb::spin_mutex mutex_;
+    std::optional<message> held_;
+    tbb::flow::limiter_node<message> limiter_;
+    tbb::flow::function_node<message, tbb::flow::continue_msg, tbb::flow::lightweight> gate_;
+    tbb::flow::broadcast_node<message> admitted_;
+  };
+}
+
+#endif // meld_core_in_flight_limiter_hpp
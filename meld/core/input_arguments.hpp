@@ -3,6 +3,7 @@
 
 #include "meld/core/message.hpp"
 #include "meld/core/specified_label.hpp"
+#include "meld/model/owned.hpp"
 
 #include "fmt/format.h"
 
@@ -12,20 +13,77 @@
 #include <set>
 #include <string>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 
 namespace meld {
   template <typename T, std::size_t JoinNodePort>
   struct retriever {
     using handle_arg_t = typename handle_for<T>::value_type;
+
+    explicit retriever(specified_label l) : label{std::move(l)}, id{label.name.full()} {}
+
     specified_label label;
+    product_id id; // Resolved once, so that retrieval does not build the product name
+    std::size_t consumers{}; // Zero if not known
+
     auto retrieve(auto const& messages) const
     {
-      return std::get<JoinNodePort>(messages).store->template get_handle<handle_arg_t>(
-        label.name.full());
+      auto const& store = std::get<JoinNodePort>(messages).store;
+      auto h = store->template get_handle<handle_arg_t>(id);
+      if constexpr (is_owned_v<T>) {
+        using owned_t = std::remove_cvref_t<T>;
+        if (consumers == 1ull and sole_delivery(messages)) {
+          // The product object itself is not const; only the store's view of it is.
+          return owned_t{std::move(const_cast<handle_arg_t&>(*h))};
+        }
+        return owned_t{*h};
+      }
+      else {
+        return h;
+      }
+    }
+
+    void finished_with(auto const& messages) const
+    {
+      if (consumers != 0ull and sole_delivery(messages)) {
+        std::get<JoinNodePort>(messages).store->finished_with(id, consumers);
+      }
+    }
+
+  private:
+    // A store that is less derived than the most-derived input store is sent to the node
+    // for each of its descendants.  Its products can thus be neither handed over nor
+    // released by the node.
+    static bool sole_delivery(auto const& messages)
+    {
+      auto const& msg = std::get<JoinNodePort>(messages);
+      return not msg.redelivered and
+             msg.store->id()->depth() == most_derived(messages).store->id()->depth();
     }
   };
 
+  template <typename InputArgs>
+  void set_consumer_count(InputArgs& args,
+                          specified_label const& product_label,
+                          std::size_t const count)
+  {
+    auto set_count = [&product_label, count](auto& retriever) {
+      if (retriever.label == product_label) {
+        retriever.consumers = count;
+      }
+    };
+    std::apply([&set_count](auto&... retrievers) { (set_count(retrievers), ...); }, args);
+  }
+
+  // Must be called once the node's user function has finished with the input products.
+  template <typename InputArgs>
+  void finished_with_inputs(InputArgs const& args, auto const& messages)
+  {
+    std::apply([&messages](auto const&... retrievers) { (retrievers.finished_with(messages), ...); },
+               args);
+  }
+
   template <typename InputTypes, std::size_t... Is>
   auto form_input_arguments_impl(std::array<specified_label, sizeof...(Is)> args,
                                  std::index_sequence<Is...>)
@@ -2,14 +2,31 @@
 #include "meld/model/level_id.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <iterator>
 #include <stdexcept>
 #include <tuple>
 
+namespace {
+  std::atomic<bool> oldest_first_scheduling{false};
+}
+
 namespace meld {
 
+  void enable_oldest_first(bool const enable) noexcept { oldest_first_scheduling = enable; }
+  bool oldest_first_enabled() noexcept { return oldest_first_scheduling; }
+
   std::size_t MessageHasher::operator()(message const& msg) const noexcept { return msg.id; }
 
+  message ancestor_message(message const& msg, std::size_t const depth)
+  {
+    auto store = msg.store;
+    for (std::size_t i = 0ull; i != depth; ++i) {
+      store = store->parent();
+    }
+    return {std::move(store), msg.eom, msg.id, msg.original_id, depth != 0ull};
+  }
+
   message const& more_derived(message const& a, message const& b)
   {
     if (a.store->id()->depth() > b.store->id()->depth()) {
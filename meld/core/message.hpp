@@ -2,6 +2,7 @@
 #define meld_core_message_hpp
 
 #include "meld/core/fwd.hpp"
+#include "meld/core/resource_chain.hpp"
 #include "meld/core/specified_label.hpp"
 #include "meld/model/handle.hpp"
 #include "meld/model/product_store.hpp"
@@ -9,11 +10,14 @@
 
 #include "oneapi/tbb/flow_graph.h" // <-- belongs somewhere else
 
+#include <cassert>
 #include <cstddef>
+#include <memory>
 #include <span>
 #include <stdexcept>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace meld {
@@ -23,6 +27,9 @@ namespace meld {
     end_of_message_ptr eom;
     std::size_t id;
     std::size_t original_id{-1ull}; // Used during flush
+    // True if the store has already been sent to the node, or if it is sent on behalf of
+    // one of its descendants.  The store's products are then not handed over or released.
+    bool redelivered{false};
   };
 
   template <std::size_t N>
@@ -32,6 +39,21 @@ namespace meld {
     std::size_t operator()(message const& msg) const noexcept;
   };
 
+  // Returns the message for the ancestor of the message's store that is the given number
+  // of generations above it.  An ancestor's message is marked as redelivered.
+  message ancestor_message(message const& msg, std::size_t depth);
+
+  // Assembles the messages for all input ports of a node, where the store for each port
+  // is the ancestor of the message's store at the corresponding depth.
+  template <std::size_t N>
+  messages_t<N> assemble_messages(message const& msg, std::span<std::size_t const> depths)
+  {
+    assert(size(depths) == N);
+    return [&msg, depths]<std::size_t... Is>(std::index_sequence<Is...>) {
+      return messages_t<N>{ancestor_message(msg, depths[Is])...};
+    }(std::make_index_sequence<N>{});
+  }
+
   // Overload for use with most_derived
   message const& more_derived(message const& a, message const& b);
 
@@ -58,6 +80,74 @@ namespace meld {
     return join_or_none_t<sizeof...(Is)>{g, type_t<MessageHasher, Is>{}...};
   }
 
+  // When a node's concurrency is limited, messages can wait for the node to become
+  // available.  By default, the waiting messages are handed to the node body in the order
+  // in which they arrived.  If oldest-first scheduling is enabled, they are instead handed
+  // to the body in the order of their message IDs, so that the stores read earliest from
+  // the source are finished first.  The policy applies to the nodes created after it has
+  // been set.
+  void enable_oldest_first(bool enable = true) noexcept;
+  bool oldest_first_enabled() noexcept;
+
+  template <std::size_t N>
+  struct oldest_first {
+    bool operator()(messages_t<N> const& a, messages_t<N> const& b) const
+    {
+      return most_derived(a).id > most_derived(b).id;
+    }
+  };
+
+  template <std::size_t N>
+  using oldest_first_queue_t = tbb::flow::priority_queue_node<messages_t<N>, oldest_first<N>>;
+
+  template <std::size_t N>
+  class ordered_edge {
+    using buffer_t = tbb::flow::buffer_node<messages_t<N>>;
+
+  public:
+    // The body is expected to use the tbb::flow::rejecting policy so that it pulls from the
+    // buffer whenever it is available.  If the node uses shared resources, the messages
+    // are ordered before the resources' tokens are acquired.
+    //
+    // Making an edge from a buffer spawns a task that forwards the buffered messages.  The
+    // graph must therefore complete its tasks before the nodes are destroyed (see
+    // ~framework_graph), even if it has never been executed.
+    template <typename Body>
+    ordered_edge(tbb::flow::graph& g,
+                 std::size_t const concurrency,
+                 join_or_none_t<N>& join,
+                 Body& body,
+                 serializer_nodes const& resources = {})
+    {
+      if (concurrency == tbb::flow::unlimited and empty(resources)) {
+        make_edge(join, body);
+        entry_ = &body;
+        return;
+      }
+      if (oldest_first_enabled()) {
+        buffer_ = std::make_unique<oldest_first_queue_t<N>>(g);
+      }
+      else {
+        buffer_ = std::make_unique<tbb::flow::queue_node<messages_t<N>>>(g);
+      }
+      make_edge(join, *buffer_);
+      entry_ = buffer_.get();
+      chain_ = std::make_unique<resource_chain<messages_t<N>>>(g, *buffer_, resources, body);
+    }
+
+    // Sends messages that have been assembled upstream (see multiplexer) to the node,
+    // bypassing the join.
+    void try_put_all(message const& msg, std::span<std::size_t const> depths)
+    {
+      entry_->try_put(assemble_messages<N>(msg, depths));
+    }
+
+  private:
+    tbb::flow::receiver<messages_t<N>>* entry_;
+    std::unique_ptr<buffer_t> buffer_;
+    std::unique_ptr<resource_chain<messages_t<N>>> chain_;
+  };
+
   template <std::size_t N>
   std::vector<tbb::flow::receiver<message>*> input_ports(join_or_none_t<N>& join)
   {
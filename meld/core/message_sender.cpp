@@ -8,8 +8,9 @@
 namespace meld {
   message_sender::message_sender(level_hierarchy& hierarchy,
                                  multiplexer& mplexer,
-                                 std::stack<end_of_message_ptr>& eoms) :
-    hierarchy_{hierarchy}, multiplexer_{mplexer}, eoms_{eoms}
+                                 std::stack<end_of_message_ptr>& eoms,
+                                 in_flight_limiter* limiter) :
+    hierarchy_{hierarchy}, multiplexer_{mplexer}, eoms_{eoms}, limiter_{limiter}
   {
   }
 
@@ -22,10 +23,12 @@ namespace meld {
     auto parent_eom = eoms_.top();
     end_of_message_ptr current_eom{};
     if (parent_eom == nullptr) {
-      current_eom = eoms_.emplace(end_of_message::make_base(&hierarchy_, store->id()));
+      current_eom =
+        eoms_.emplace(end_of_message::make_base(&hierarchy_, store->id(), limiter_, message_id));
     }
     else {
-      current_eom = eoms_.emplace(parent_eom->make_child(store->id()));
+      current_eom = eoms_.emplace(
+        parent_eom->make_child(store->id(), limiter_, nullptr, message_id));
     }
     return {store, current_eom, message_id, -1ull};
   }
@@ -34,6 +37,7 @@ namespace meld {
   {
     assert(store);
     assert(store->is_flush());
+    trace::scope const trace{trace::category::flush, trace_name_};
     auto const message_id = ++calls_;
     message const msg{store, nullptr, message_id, original_message_id(store)};
     multiplexer_.try_put(std::move(msg));
@@ -5,6 +5,7 @@
 #include "meld/core/message.hpp"
 #include "meld/core/multiplexer.hpp"
 #include "meld/model/fwd.hpp"
+#include "meld/utilities/tracer.hpp"
 
 #include <map>
 #include <stack>
@@ -15,7 +16,8 @@ namespace meld {
   public:
     explicit message_sender(level_hierarchy& hierarchy,
                             multiplexer& mplexer,
-                            std::stack<end_of_message_ptr>& eoms);
+                            std::stack<end_of_message_ptr>& eoms,
+                            in_flight_limiter* limiter = nullptr);
 
     void send_flush(product_store_ptr store);
     message make_message(product_store_ptr store);
@@ -26,8 +28,10 @@ namespace meld {
     level_hierarchy& hierarchy_;
     multiplexer& multiplexer_;
     std::stack<end_of_message_ptr>& eoms_;
+    in_flight_limiter* limiter_;
     std::map<level_id_ptr, std::size_t> original_message_ids_;
     std::size_t calls_{};
+    trace::name_t trace_name_{trace::register_name("flush")};
   };
 
 }
@@ -1,10 +1,15 @@
 #include "meld/core/multiplexer.hpp"
+#include "meld/core/products_consumer.hpp"
 #include "meld/model/product_store.hpp"
 
 #include "oneapi/tbb/flow_graph.h"
 #include "spdlog/spdlog.h"
 
 #include <algorithm>
+#include <cassert>
+#include <ranges>
+#include <set>
+#include <string>
 #include <stdexcept>
 
 using namespace std::chrono;
@@ -31,50 +36,162 @@ namespace {
       fmt::format("Store not available that provides product {}", label.to_string()));
   }
 
-  struct sender_slot {
-    tbb::flow::receiver<meld::message>* port;
-    meld::product_store_const_ptr store;
-    void operator()(meld::end_of_message_ptr eom, std::size_t message_id) const
-    {
-      port->try_put({store, eom, message_id});
+  std::size_t depth_of(meld::product_store_const_ptr const& store,
+                       meld::product_store_const_ptr const& ancestor)
+  {
+    std::size_t depth{};
+    for (auto const* current = store.get(); current != ancestor.get();
+         current = current->parent().get()) {
+      assert(current);
+      ++depth;
     }
-  };
+    return depth;
+  }
+}
+
+namespace meld {
+
+  multiplexer::multiplexer(tbb::flow::graph& g, bool debug) :
+    base{g, tbb::flow::unlimited, std::bind_front(&multiplexer::multiplex, this)}, debug_{debug}
+  {
+  }
 
-  std::vector<sender_slot> senders_for(meld::product_store_const_ptr store,
-                                       meld::multiplexer::named_input_ports_t const& ports)
+  void multiplexer::finalize(head_ports_t head_ports,
+                             nodes_t const& nodes,
+                             nodes_t const& targeted)
   {
-    std::vector<sender_slot> result;
-    result.reserve(ports.size());
-    for (auto const& [product_label, port] : ports) {
-      auto store_to_send = store_for(store, product_label);
-      if (not store_to_send) {
-        // This is fine if the store is not expected to contain the product.
+    head_ports_ = std::move(head_ports);
+    for (auto const& [node_name, ports] : head_ports_) {
+      if (auto it = targeted.find(node_name);
+          it != targeted.end() and size(ports) == it->second->num_inputs()) {
+        targeted_nodes_.insert(*it);
+      }
+      else {
+        for (auto const& port : ports) {
+          flush_ports_.push_back(port.port);
+        }
+      }
+
+      // Flush messages for non-targeted nodes are still sent to each port, and they are
+      // assembled by the join.
+      auto it = nodes.find(node_name);
+      if (it == nodes.end()) {
         continue;
       }
+      if (auto const n = it->second->num_inputs(); n > 1ull and size(ports) == n) {
+        assembled_nodes_.insert(*it);
+      }
+    }
+  }
+
+  auto multiplexer::routes_for(product_store_const_ptr const& store) -> routes_t const&
+  {
+    // The layout of a store's parent has already been computed when the parent was
+    // multiplexed, so only the products of the store itself are examined here.
+    auto const* key = store->layout();
+    if (auto it = routes_.find(key); it != routes_.end()) {
+      return it->second;
+    }
+    // If two threads simultaneously create routes for the same key, the routes are
+    // identical, and whichever is inserted first is used.
+    return routes_.emplace(key, make_routes(store)).first->second;
+  }
 
-      if (auto const& allowed_family = product_label.family; not allowed_family.empty()) {
-        if (store_to_send->level_name() != allowed_family) {
-          continue;
+  auto multiplexer::make_routes(product_store_const_ptr const& store) const -> routes_t
+  {
+    routes_t result;
+    std::set<std::string> most_derived_for;
+    for (auto const& [node_name, ports] : head_ports_) {
+      // FIXME: Should make sure that the received store has a level equal to the most
+      //        derived store required by the algorithm.
+      std::vector<route> node_routes;
+      for (auto const& [product_label, port] : ports) {
+        auto store_to_send = store_for(store, product_label);
+        if (not store_to_send) {
+          // This is fine if the store is not expected to contain the product.
+          break;
         }
+
+        if (auto const& allowed_family = product_label.family; not allowed_family.empty()) {
+          if (store_to_send->level_name() != allowed_family) {
+            break;
+          }
+        }
+
+        node_routes.push_back({port, depth_of(store, store_to_send)});
+      }
+
+      if (size(node_routes) != size(ports)) {
+        // Not enough stores to ports of the node
+        continue;
       }
 
-      result.push_back({port, store_to_send});
+      if (targeted_nodes_.contains(node_name) and
+          std::ranges::min(node_routes | std::views::transform(&route::depth)) == 0ull) {
+        most_derived_for.insert(node_name);
+      }
+
+      // The ports of an assembled node are ordered as its input ports (see edge_maker).
+      if (auto it = assembled_nodes_.find(node_name); it != assembled_nodes_.end()) {
+        auto depths = node_routes | std::views::transform(&route::depth);
+        result.nodes.push_back({it->second, {begin(depths), end(depths)}});
+        continue;
+      }
+      result.ports.insert(result.ports.end(), begin(node_routes), end(node_routes));
+    }
+
+    // A targeted node requires the flush message of a store that it processes, or of a
+    // store whose level is one of its flush levels.
+    auto const& level_name = store->level_name();
+    for (auto const& [node_name, node] : targeted_nodes_) {
+      if (most_derived_for.contains(node_name) or
+          std::ranges::count(node->flush_levels(), level_name) != 0) {
+        result.flush_nodes.push_back({node, std::vector<std::size_t>(node->num_inputs())});
+      }
     }
     return result;
   }
-}
 
-namespace meld {
+  void multiplexer::route_flush(message const& msg)
+  {
+    routes_t const* routes{nullptr};
+    {
+      pending_flushes_t::accessor a;
+      if (pending_flushes_.insert(a, msg.original_id)) {
+        a->second.flush = msg;
+        return;
+      }
+      routes = a->second.routes;
+      pending_flushes_.erase(a);
+    }
+    send_flush(msg, *routes);
+  }
 
-  multiplexer::multiplexer(tbb::flow::graph& g, bool debug) :
-    base{g, tbb::flow::unlimited, std::bind_front(&multiplexer::multiplex, this)}, debug_{debug}
+  void multiplexer::routed_data(message const& msg, routes_t const& routes)
   {
+    message flush;
+    {
+      pending_flushes_t::accessor a;
+      if (pending_flushes_.insert(a, msg.id)) {
+        a->second.routes = &routes;
+        return;
+      }
+      flush = std::move(a->second.flush);
+      pending_flushes_.erase(a);
+    }
+    send_flush(flush, routes);
   }
 
-  void multiplexer::finalize(head_ports_t head_ports) { head_ports_ = std::move(head_ports); }
+  void multiplexer::send_flush(message const& msg, routes_t const& routes)
+  {
+    for (auto const& [node, depths] : routes.flush_nodes) {
+      node->try_put_all(msg, depths);
+    }
+  }
 
   tbb::flow::continue_msg multiplexer::multiplex(message const& msg)
   {
+    trace::scope const trace{trace::category::multiplexer, trace_name_};
     ++received_messages_;
     auto const& [store, eom, message_id] = std::tie(msg.store, msg.eom, msg.id);
     if (debug_) {
@@ -86,37 +203,40 @@ namespace meld {
     auto start_time = steady_clock::now();
 
     if (store->is_flush()) {
-      for (auto const& [_, head_ports] : head_ports_) {
-        for (auto const& head_port : head_ports) {
-          head_port.port->try_put(msg);
-        }
+      for (auto* port : flush_ports_) {
+        port->try_put(msg);
+      }
+      if (not empty(targeted_nodes_)) {
+        route_flush(msg);
       }
       return {};
     }
 
-    for (auto const& [node_name, ports] : head_ports_) {
-      // FIXME: Should make sure that the received store has a level equal to the most
-      //        derived store required by the algorithm.
-      auto const senders = senders_for(store, ports);
-      if (size(senders) != size(ports)) {
-        // Not enough stores to ports of the node
-        continue;
-      }
-
-      for (auto const& sender : senders) {
-        sender(eom, message_id);
-      }
+    auto const& routes = routes_for(store);
+    for (auto const& [port, depth] : routes.ports) {
+      port->try_put(ancestor_message(msg, depth));
+    }
+    for (auto const& [node, depths] : routes.nodes) {
+      node->try_put_all(msg, depths);
+    }
+    if (not empty(targeted_nodes_)) {
+      routed_data(msg, routes);
     }
 
-    execution_time_ += duration_cast<microseconds>(steady_clock::now() - start_time);
+    execution_time_ += duration_cast<nanoseconds>(steady_clock::now() - start_time).count();
     return {};
   }
 
   multiplexer::~multiplexer()
   {
-    spdlog::debug("Routed {} messages in {} microseconds ({:.3f} microseconds per message)",
+    if (pending_flushes_.size() > 0ull) {
+      spdlog::warn("Multiplexer has {} stores with unmatched data or flush messages.",
+                   pending_flushes_.size());
+    }
+    auto const execution_time = execution_time_.load() / 1e3;
+    spdlog::debug("Routed {} messages in {:.0f} microseconds ({:.3f} microseconds per message)",
                   received_messages_,
-                  execution_time_.count(),
-                  execution_time_.count() / received_messages_);
+                  execution_time,
+                  execution_time / received_messages_);
   }
 }
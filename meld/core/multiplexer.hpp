@@ -1,18 +1,23 @@
 #ifndef meld_core_multiplexer_hpp
 #define meld_core_multiplexer_hpp
 
+#include "meld/core/fwd.hpp"
 #include "meld/core/message.hpp"
 #include "meld/model/level_id.hpp"
+#include "meld/utilities/tracer.hpp"
 
 #include "oneapi/tbb/concurrent_hash_map.h"
+#include "oneapi/tbb/concurrent_unordered_map.h"
 #include "oneapi/tbb/flow_graph.h"
 
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <map>
 #include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace meld {
 
@@ -28,19 +33,70 @@ namespace meld {
     };
     using named_input_ports_t = std::vector<named_input_port>;
     using head_ports_t = std::map<std::string, named_input_ports_t>;
+    using nodes_t = std::map<std::string, products_consumer*>;
 
     explicit multiplexer(tbb::flow::graph& g, bool debug = false);
     tbb::flow::continue_msg multiplex(message const& msg);
 
-    void finalize(head_ports_t head_ports);
+    // A multi-input node whose input ports are all routed by the multiplexer receives its
+    // messages at once (see products_consumer::try_put_all), thus bypassing the join.  The
+    // nodes supplied here are candidates for doing so.
+    //
+    // Flush messages are sent to each head port, except for the targeted nodes, which
+    // receive (at once) only the flush messages of the stores that have been routed to them
+    // and of the levels listed by their flush_levels().  A targeted node must have all of
+    // its input ports routed by the multiplexer.
+    void finalize(head_ports_t head_ports,
+                  nodes_t const& nodes = {},
+                  nodes_t const& targeted = {});
 
     head_ports_t const& downstream_ports() const noexcept { return head_ports_; }
 
   private:
+    // A route identifies a port and the store (expressed as the number of parent hops
+    // from the store of the received message) that is to be sent to that port.
+    struct route {
+      tbb::flow::receiver<message>* port;
+      std::size_t depth;
+    };
+    // The depths of an assembled route are ordered as the node's input ports.
+    struct assembled_route {
+      products_consumer* node;
+      std::vector<std::size_t> depths;
+    };
+    struct routes_t {
+      std::vector<route> ports;
+      std::vector<assembled_route> nodes;
+      // Targeted nodes that receive the flush message for the routed store (all depths 0)
+      std::vector<assembled_route> flush_nodes;
+    };
+
+    // A flush message is sent to the targeted nodes only once the routes of its store are
+    // known.  The entry is keyed by the message ID of the store, and it is created by
+    // whichever of the data or flush messages is multiplexed first.
+    struct pending_flush {
+      routes_t const* routes{nullptr};
+      message flush;
+    };
+    using pending_flushes_t = tbb::concurrent_hash_map<std::size_t, pending_flush>;
+
+    routes_t const& routes_for(product_store_const_ptr const& store);
+    routes_t make_routes(product_store_const_ptr const& store) const;
+    void route_flush(message const& msg);
+    void routed_data(message const& msg, routes_t const& routes);
+    static void send_flush(message const& msg, routes_t const& routes);
+
     head_ports_t head_ports_;
+    nodes_t assembled_nodes_;
+    nodes_t targeted_nodes_;
+    pending_flushes_t pending_flushes_;
+    std::vector<tbb::flow::receiver<message>*> flush_ports_;
+    // Stores with the same layout are routed identically.
+    tbb::concurrent_unordered_map<store_layout const*, routes_t> routes_;
     bool debug_;
     std::atomic<std::size_t> received_messages_{};
-    std::chrono::duration<float, std::chrono::microseconds::period> execution_time_{};
+    std::atomic<std::chrono::nanoseconds::rep> execution_time_{};
+    trace::name_t trace_name_{trace::register_name("multiplexer")};
   };
 
 }
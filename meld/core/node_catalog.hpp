@@ -8,9 +8,14 @@
 #include "meld/core/declared_splitter.hpp"
 #include "meld/core/declared_transform.hpp"
 #include "meld/core/registrar.hpp"
+#include "meld/graph/serializer_node.hpp"
+
+#include "oneapi/tbb/flow_graph.h"
 
 namespace meld {
   struct node_catalog {
+    explicit node_catalog(tbb::flow::graph& g) : serializers_{g} {}
+
     auto register_predicate(std::vector<std::string>& errors)
     {
       return registrar{predicates_, errors};
@@ -30,6 +35,8 @@ namespace meld {
       return registrar{transforms_, errors};
     }
 
+    // The serializers must outlive the nodes that use them.
+    serializers serializers_;
     declared_predicates predicates_{};
     declared_monitors monitors_{};
     declared_outputs outputs_{};
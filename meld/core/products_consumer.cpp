@@ -2,8 +2,10 @@
 
 namespace meld {
 
-  products_consumer::products_consumer(qualified_name name, std::vector<std::string> predicates) :
-    consumer{std::move(name), std::move(predicates)}
+  products_consumer::products_consumer(qualified_name name,
+                                       std::vector<std::string> predicates,
+                                       serializer_nodes resources) :
+    consumer{std::move(name), std::move(predicates), std::move(resources)}
   {
   }
 
@@ -11,6 +13,8 @@ namespace meld {
 
   std::size_t products_consumer::num_inputs() const { return input().size(); }
 
+  std::vector<std::string> products_consumer::flush_levels() const { return {}; }
+
   tbb::flow::receiver<message>& products_consumer::port(specified_label const& product_label)
   {
     return port_for(product_label);
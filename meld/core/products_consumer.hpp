@@ -10,6 +10,7 @@
 
 #include "oneapi/tbb/flow_graph.h"
 
+#include <cstddef>
 #include <span>
 #include <string>
 #include <vector>
@@ -17,7 +18,9 @@
 namespace meld {
   class products_consumer : public consumer {
   public:
-    products_consumer(qualified_name name, std::vector<std::string> predicates);
+    products_consumer(qualified_name name,
+                      std::vector<std::string> predicates,
+                      serializer_nodes resources);
 
     virtual ~products_consumer();
 
@@ -26,6 +29,21 @@ namespace meld {
     tbb::flow::receiver<message>& port(specified_label const& product_label);
     virtual std::vector<tbb::flow::receiver<message>*> ports() = 0;
     virtual specified_labels input() const = 0;
+
+    // Sends the messages for all input ports at once, bypassing the join that would
+    // otherwise assemble them (see multiplexer).  The store for each input port, in the
+    // order of input(), is the ancestor of the message's store at the corresponding depth.
+    virtual void try_put_all(message const& msg, std::span<std::size_t const> depths) = 0;
+
+    // The levels whose flush messages the node requires even if it does not process
+    // their stores (e.g. the interval of a reduction)
+    virtual std::vector<std::string> flush_levels() const;
+
+    // Called when the graph is finalized with the number of nodes (including this one and
+    // any outputs) that consume the product.  Once all of them have finished with a given
+    // product, its payload is released.  If the node is the only consumer, the product
+    // may be handed over to the node (see meld/model/owned.hpp).
+    virtual void set_consumer_count(specified_label const& product_label, std::size_t count) = 0;
     virtual std::size_t num_calls() const = 0;
 
   private:
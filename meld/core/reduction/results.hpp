@@ -0,0 +1,67 @@
+#ifndef meld_core_reduction_results_hpp
+#define meld_core_reduction_results_hpp
+
+// =======================================================================================
+// The result of a reduction is accumulated separately for each reduction interval (e.g.
+// for each run).  The result for an interval is created when the first store of the
+// interval is processed, and it is erased once the interval has been committed.  The
+// memory used by a reduction is thus proportional to the number of open intervals
+// instead of to the number of intervals processed during the job.
+// =======================================================================================
+
+#include "meld/model/level_id.hpp"
+
+#include "oneapi/tbb/concurrent_hash_map.h"
+
+#include <cstddef>
+#include <memory>
+
+namespace meld {
+  template <typename R>
+  class reduction_results {
+    using results_t = tbb::concurrent_hash_map<level_id::hash_type, std::unique_ptr<R>>;
+    using accessor = typename results_t::accessor;
+    using const_accessor = typename results_t::const_accessor;
+
+  public:
+    // Returns the result for the interval, which is created by calling 'make' if it does
+    // not yet exist.  The reference remains valid until the result is released.
+    template <typename Make>
+    R& get_or_make(level_id::hash_type const interval, Make make)
+    {
+      if (const_accessor a; results_.find(a, interval)) {
+        return *a->second;
+      }
+      accessor a;
+      if (results_.insert(a, interval)) {
+        try {
+          a->second = make();
+        }
+        catch (...) {
+          results_.erase(a);
+          throw;
+        }
+      }
+      return *a->second;
+    }
+
+    // Removes the result for the interval from the container.  The result may no longer
+    // be in use by any other thread.
+    std::unique_ptr<R> release(level_id::hash_type const interval)
+    {
+      std::unique_ptr<R> result;
+      if (accessor a; results_.find(a, interval)) {
+        result = std::move(a->second);
+        results_.erase(a);
+      }
+      return result;
+    }
+
+    std::size_t size() const { return results_.size(); }
+
+  private:
+    results_t results_;
+  };
+}
+
+#endif // meld_core_reduction_results_hpp
@@ -0,0 +1,220 @@
+#ifndef meld_core_replicas_hpp
+#define meld_core_replicas_hpp
+
+// =======================================================================================
+// A replicas object owns several instances of a user-provided class, each of which is
+// used by at most one thread at a time.  This allows the member functions of a class
+// that is not thread-safe to be invoked concurrently: each invocation is dispatched to
+// whichever instance is currently free.
+//
+// The instances are created when a bound object is replicated:
+//
+//   g.make<T>(args...).replicated(n).with(&T::f)...
+//
+// The constructor arguments are held by an instance_source until the instances are
+// created.  All but the last of the n instances are constructed from the held arguments,
+// which must therefore be usable as const lvalues; the last instance (or the only
+// instance of an object that is not replicated) is constructed by forwarding them.  An
+// object must thus be replicated before any of its functions are registered.
+//
+// The replicas are represented by a resource with one token per instance, which is used
+// by each node registered for the object (see resource_chain).  An invocation starts only
+// once it holds a token, so that a free instance is always available.
+// =======================================================================================
+
+#include "meld/graph/serializer_node.hpp"
+
+#include "boost/core/demangle.hpp"
+#include "oneapi/tbb/concurrent_queue.h"
+#include "spdlog/fmt/fmt.h"
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace meld {
+  template <typename T>
+  class instance_source {
+  public:
+    virtual ~instance_source() = default;
+
+    // The instance of an object that is not replicated, which is constructed the first
+    // time it is requested.
+    std::shared_ptr<T> const& instance()
+    {
+      if (not instance_) {
+        instance_ = make_last();
+      }
+      return instance_;
+    }
+
+    bool used() const noexcept { return used_; }
+    virtual bool replicable() const noexcept = 0;
+
+    std::vector<std::shared_ptr<T>> instances(std::size_t const n)
+    {
+      std::vector<std::shared_ptr<T>> result;
+      result.reserve(n);
+      while (size(result) + 1 < n) {
+        result.push_back(make_copy());
+      }
+      result.push_back(make_last());
+      return result;
+    }
+
+  private:
+    virtual std::shared_ptr<T> make_copy() const = 0;
+    virtual std::shared_ptr<T> forward_arguments() = 0;
+
+    std::shared_ptr<T> make_last()
+    {
+      used_ = true;
+      return forward_arguments();
+    }
+
+    std::shared_ptr<T> instance_;
+    bool used_{false};
+  };
+
+  // An argument passed as an lvalue is held by reference; an rvalue is held by value.
+  template <typename T, typename... Args>
+  class held_arguments : public instance_source<T> {
+  public:
+    template <typename... Ts>
+    explicit held_arguments(Ts&&... ts) : args_{std::forward<Ts>(ts)...}
+    {
+    }
+
+  private:
+    static constexpr bool is_replicable = std::constructible_from<T, Args const&...>;
+
+    bool replicable() const noexcept final { return is_replicable; }
+
+    std::shared_ptr<T> make_copy() const final
+    {
+      if constexpr (is_replicable) {
+        return std::apply([](Args const&... args) { return std::make_shared<T>(args...); },
+                          args_);
+      }
+      else {
+        return nullptr;
+      }
+    }
+
+    std::shared_ptr<T> forward_arguments() final
+    {
+      return std::apply(
+        [](Args&... args) { return std::make_shared<T>(std::forward<Args>(args)...); }, args_);
+    }
+
+    std::tuple<Args...> args_;
+  };
+
+  template <typename T, typename... Args>
+  std::shared_ptr<instance_source<T>> make_instance_source(Args&&... args)
+  {
+    return std::make_shared<held_arguments<T, Args...>>(std::forward<Args>(args)...);
+  }
+
+  namespace detail {
+    inline std::atomic<std::size_t> replicas_counter{};
+  }
+
+  template <typename T>
+  class replicas {
+  public:
+    replicas(std::vector<std::shared_ptr<T>> instances, serializers& resources) :
+      instances_{std::move(instances)},
+      resource_name_{fmt::format("{} replicas #{}",
+                                 boost::core::demangle(typeid(T).name()),
+                                 ++detail::replicas_counter)}
+    {
+      resources.get(resource_name_).set_tokens(instances_.size());
+      for (auto const& instance : instances_) {
+        free_.push(instance.get());
+      }
+    }
+
+    std::size_t size() const noexcept { return instances_.size(); }
+    std::string const& resource_name() const noexcept { return resource_name_; }
+
+    template <typename F>
+    decltype(auto) invoke(F&& f)
+    {
+      T* instance{};
+      if (not free_.try_pop(instance)) {
+        throw std::logic_error("No free instance of " + resource_name_ +
+                               "; a node invoked it without holding the replicas' resource.");
+      }
+      sentry const s{free_, instance};
+      return std::forward<F>(f)(*instance);
+    }
+
+  private:
+    class sentry {
+    public:
+      sentry(tbb::concurrent_queue<T*>& free, T* instance) : free_{free}, instance_{instance} {}
+      ~sentry() { free_.push(instance_); }
+
+    private:
+      tbb::concurrent_queue<T*>& free_;
+      T* instance_;
+    };
+
+    std::vector<std::shared_ptr<T>> instances_;
+    std::string resource_name_;
+    tbb::concurrent_queue<T*> free_;
+  };
+
+  template <typename T>
+  std::shared_ptr<replicas<T>> make_replicas(instance_source<T>& source,
+                                             std::size_t const n,
+                                             serializers& resources,
+                                             std::vector<std::string>& errors)
+  {
+    auto const type_name = boost::core::demangle(typeid(T).name());
+    if (n == 0ull) {
+      errors.push_back(fmt::format("Cannot create zero replicas of type '{}'", type_name));
+      return nullptr;
+    }
+    if (source.used()) {
+      errors.push_back(fmt::format(
+        "Cannot replicate type '{}' once an instance of it has been created", type_name));
+      return nullptr;
+    }
+    if (n > 1ull and not source.replicable()) {
+      errors.push_back(fmt::format(
+        "Cannot replicate type '{}': it cannot be constructed from const constructor arguments",
+        type_name));
+      return nullptr;
+    }
+    return std::make_shared<replicas<T>>(source.instances(n), resources);
+  }
+
+  template <typename R, typename T, typename... Args>
+  auto delegate(std::shared_ptr<replicas<T>>& pool, R (T::*f)(Args...))
+  {
+    return std::function{[pool, f](Args... args) -> R {
+      return pool->invoke([&](T& t) -> R { return (t.*f)(args...); });
+    }};
+  }
+
+  template <typename R, typename T, typename... Args>
+  auto delegate(std::shared_ptr<replicas<T>>& pool, R (T::*f)(Args...) const)
+  {
+    return std::function{[pool, f](Args... args) -> R {
+      return pool->invoke([&](T& t) -> R { return (t.*f)(args...); });
+    }};
+  }
+}
+
+#endif // meld_core_replicas_hpp
@@ -0,0 +1,72 @@
+#ifndef meld_core_resource_chain_hpp
+#define meld_core_resource_chain_hpp
+
+// =======================================================================================
+// A node that uses shared resources (e.g. a thread-unsafe library, or a pool of database
+// connections) may execute only when it holds one token from each of its resources.
+// Each resource is represented by a serializer_node, which buffers as many tokens as the
+// resource allows concurrent users.
+//
+// The resource_chain connects an upstream buffering node to the node's body through one
+// stage per resource:
+//
+//   upstream ──> join (reserving) ──> strip token ──> queue ──> ... ──> body
+//                  ^
+//   serializer ────┘
+//
+// A message passes a stage only when a token of that stage's resource is available.  The
+// tokens are acquired in the order of the resources, which the serializers object sorts
+// by name, so that nodes sharing several resources cannot deadlock.  The tokens are
+// returned to the serializers once the node's body has finished with the message (see
+// consumer::hold_resources).
+// =======================================================================================
+
+#include "meld/graph/serializer_node.hpp"
+
+#include "oneapi/tbb/flow_graph.h"
+
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace meld {
+  template <typename T>
+  class resource_chain {
+  public:
+    // The upstream node must support reservations (e.g. a queue_node).
+    resource_chain(tbb::flow::graph& g,
+                   tbb::flow::sender<T>& upstream,
+                   serializer_nodes const& resources,
+                   tbb::flow::receiver<T>& downstream)
+    {
+      auto* previous = &upstream;
+      for (auto* resource : resources) {
+        previous = &stages_.emplace_back(std::make_unique<stage>(g, *previous, *resource))->output;
+      }
+      make_edge(*previous, downstream);
+    }
+
+  private:
+    struct stage {
+      using input_t = std::tuple<T, token_t>;
+
+      stage(tbb::flow::graph& g, tbb::flow::sender<T>& upstream, serializer_node& resource) :
+        join{g}, strip{g, tbb::flow::unlimited, [](input_t const& in) { return std::get<0>(in); }},
+        output{g}
+      {
+        make_edge(upstream, input_port<0>(join));
+        make_edge(resource, input_port<1>(join));
+        make_edge(join, strip);
+        make_edge(strip, output);
+      }
+
+      tbb::flow::join_node<input_t, tbb::flow::reserving> join;
+      tbb::flow::function_node<input_t, T> strip;
+      tbb::flow::queue_node<T> output;
+    };
+
+    std::vector<std::unique_ptr<stage>> stages_;
+  };
+}
+
+#endif // meld_core_resource_chain_hpp
@@ -44,13 +44,20 @@ namespace meld {
     if (not store->contains_product("[flush]")) {
       return;
     }
+    set_flush_value(store->get_product<flush_counts_ptr>("[flush]"), original_message_id);
+  }
 
+  void store_counter::set_flush_value(flush_counts_ptr counts,
+                                      std::size_t const original_message_id)
+  {
+    // The message ID is stored first so that it is visible to whichever thread sees the
+    // counts and completes the store.
+    original_message_id_ = original_message_id;
 #ifdef __cpp_lib_atomic_shared_ptr
-    flush_counts_ = store->get_product<flush_counts_ptr>("[flush]");
+    flush_counts_ = std::move(counts);
 #else
-    atomic_store(&flush_counts_, store->get_product<flush_counts_ptr>("[flush]"));
+    atomic_store(&flush_counts_, std::move(counts));
 #endif
-    original_message_id_ = original_message_id;
   }
 
   void store_counter::increment(level_id::hash_type const level_hash) { ++counts_[level_hash]; }
@@ -90,10 +97,16 @@ namespace meld {
   unsigned int store_counter::original_message_id() const noexcept { return original_message_id_; }
 
   store_counter& count_stores::counter_for(level_id::hash_type const hash)
+  {
+    bool created [[maybe_unused]]{false};
+    return counter_for(hash, created);
+  }
+
+  store_counter& count_stores::counter_for(level_id::hash_type const hash, bool& created)
   {
     counter_accessor ca;
     if (!counters_.find(ca, hash)) {
-      counters_.emplace(ca, hash, std::make_unique<store_counter>());
+      created = counters_.emplace(ca, hash, std::make_unique<store_counter>());
     }
     return *ca->second;
   }
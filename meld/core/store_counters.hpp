@@ -45,6 +45,8 @@ namespace meld {
   class store_counter {
   public:
     void set_flush_value(product_store_const_ptr const& ptr, std::size_t original_message_id);
+    // Used for child counts declared by the source, which may be set by several threads
+    void set_flush_value(flush_counts_ptr counts, std::size_t original_message_id);
     void increment(level_id::hash_type level_hash);
     bool is_complete();
     unsigned int original_message_id() const noexcept;
@@ -58,13 +60,16 @@ namespace meld {
 #else
     flush_counts_ptr flush_counts_{nullptr};
 #endif
-    unsigned int original_message_id_{}; // Necessary for matching inputs to downstream join nodes.
+    // Necessary for matching inputs to downstream join nodes.
+    std::atomic<unsigned int> original_message_id_{};
     std::atomic<bool> ready_to_flush_{true};
   };
 
   class count_stores {
   protected:
     store_counter& counter_for(level_id::hash_type hash);
+    // Also reports whether the counter was created by this call
+    store_counter& counter_for(level_id::hash_type hash, bool& created);
     std::unique_ptr<store_counter> done_with(level_id::hash_type hash);
 
   private:
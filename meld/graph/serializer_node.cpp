@@ -1,5 +1,7 @@
 #include "meld/graph/serializer_node.hpp"
 
+#include <algorithm>
+
 namespace meld {
   serializers::serializers(tbb::flow::graph& g) : graph_{g} {}
 
@@ -8,6 +10,20 @@ namespace meld {
     return serializers_.try_emplace(name, serializer_node{graph_, name}).first->second;
   }
 
+  serializer_nodes serializers::get(std::vector<std::string> names)
+  {
+    std::ranges::sort(names);
+    auto const [b, e] = std::ranges::unique(names);
+    names.erase(b, e);
+
+    serializer_nodes result;
+    result.reserve(size(names));
+    for (auto const& name : names) {
+      result.push_back(&get(name));
+    }
+    return result;
+  }
+
   void serializers::activate()
   {
     for (auto& [name, serializer] : serializers_) {
@@ -5,9 +5,11 @@
 
 #include "oneapi/tbb/flow_graph.h"
 
+#include <cstddef>
 #include <map>
 #include <string>
 #include <tuple>
+#include <vector>
 
 namespace meld {
 
@@ -15,8 +17,10 @@ namespace meld {
   using base_impl = tbb::flow::buffer_node<token_t>;
   class serializer_node : public base_impl {
   public:
-    explicit serializer_node(tbb::flow::graph& g, std::string const& name) :
-      base_impl{g}, name_{name}
+    explicit serializer_node(tbb::flow::graph& g,
+                             std::string const& name,
+                             std::size_t const tokens = 1) :
+      base_impl{g}, name_{name}, tokens_{tokens}
     {
     }
 
@@ -26,15 +30,22 @@ namespace meld {
       // IOW, if a container of serializers grows, the locations of the serializers can
       // move around, introducing memory errors if try_put(...) has been attempted in a
       // different location than when it's used during the graph execution.
-      try_put(1);
+      for (std::size_t i = 0; i != tokens_; ++i) {
+        try_put(1);
+      }
     }
 
     auto const& name() const { return name_; }
+    std::size_t tokens() const noexcept { return tokens_; }
+    void set_tokens(std::size_t const tokens) noexcept { tokens_ = tokens; }
 
   private:
     std::string name_;
+    std::size_t tokens_;
   };
 
+  using serializer_nodes = std::vector<serializer_node*>;
+
   class serializers {
   public:
     explicit serializers(tbb::flow::graph& g);
@@ -46,8 +57,13 @@ namespace meld {
       return std::tie(get(std::string(resources))...);
     }
 
-  private:
     serializer_node& get(std::string const& name);
+
+    // The returned serializers are ordered by name, without duplicates, so that nodes
+    // using several resources always acquire them in the same order.
+    serializer_nodes get(std::vector<std::string> names);
+
+  private:
     tbb::flow::graph& graph_;
     std::map<std::string, serializer_node> serializers_;
   };
@@ -4,11 +4,14 @@
 #include <memory>
 
 namespace meld {
+  class flush_counts;
   class level_counter;
   class level_hierarchy;
   class level_id;
   class product_store;
+  class store_layout;
 
+  using flush_counts_ptr = std::shared_ptr<flush_counts const>;
   using level_id_ptr = std::shared_ptr<level_id const>;
   using product_store_const_ptr = std::shared_ptr<product_store const>;
   using product_store_ptr = std::shared_ptr<product_store>;
@@ -2,6 +2,7 @@
 #define meld_model_handle_hpp
 
 #include "meld/model/level_id.hpp"
+#include "meld/model/owned.hpp"
 #include "meld/model/products.hpp"
 
 #include "boost/core/demangle.hpp"
@@ -103,6 +104,11 @@ namespace meld {
     using type = handle<T>;
   };
 
+  template <typename T>
+  struct handle_<owned<T>> {
+    using type = handle<T>;
+  };
+
   template <typename T>
   using handle_for = typename handle_<T>::type;
 }
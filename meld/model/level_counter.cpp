@@ -19,6 +19,15 @@ namespace meld {
   {
   }
 
+  level_counter::level_counter(level_counter* parent,
+                               std::string const& level_name,
+                               flush_counts const& declared_counts) :
+    level_counter{parent, level_name}
+  {
+    child_counts_.insert(declared_counts.begin(), declared_counts.end());
+    counts_declared_ = true;
+  }
+
   level_counter::~level_counter()
   {
     if (parent_) {
@@ -43,13 +52,21 @@ namespace meld {
     }
   }
 
-  void flush_counters::update(level_id_ptr const id)
+  void flush_counters::update(level_id_ptr const id, flush_counts_ptr const& declared_counts)
   {
     level_counter* parent_counter = nullptr;
     if (auto parent = id->parent()) {
       auto it = counters_.find(parent->hash());
       assert(it != counters_.cend());
-      parent_counter = it->second.get();
+      // A parent whose counts have been declared is not adjusted by its children.
+      if (not it->second->counts_declared()) {
+        parent_counter = it->second.get();
+      }
+    }
+    if (declared_counts) {
+      counters_[id->hash()] =
+        std::make_shared<level_counter>(parent_counter, id->level_name(), *declared_counts);
+      return;
     }
     counters_[id->hash()] = std::make_shared<level_counter>(parent_counter, id->level_name());
   }
@@ -33,14 +33,19 @@ namespace meld {
     std::map<level_id::hash_type, std::size_t> child_counts_{};
   };
 
-  using flush_counts_ptr = std::shared_ptr<flush_counts const>;
-
   class level_counter {
   public:
     level_counter();
     level_counter(level_counter* parent, std::string const& level_name);
+    // The stores nested within the counted store are not counted; the declared counts
+    // are reported instead (see product_store::declare_child_counts).
+    level_counter(level_counter* parent,
+                  std::string const& level_name,
+                  flush_counts const& declared_counts);
     ~level_counter();
 
+    bool counts_declared() const noexcept { return counts_declared_; }
+
     level_counter make_child(std::string const& level_name);
     flush_counts result() const
     {
@@ -56,11 +61,12 @@ namespace meld {
     level_counter* parent_;
     level_id::hash_type level_hash_;
     std::map<level_id::hash_type, std::size_t> child_counts_{};
+    bool counts_declared_{false};
   };
 
   class flush_counters {
   public:
-    void update(level_id_ptr const id);
+    void update(level_id_ptr const id, flush_counts_ptr const& declared_counts = nullptr);
     flush_counts extract(level_id_ptr const id);
 
   private:
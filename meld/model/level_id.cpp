@@ -4,42 +4,109 @@
 #include "boost/algorithm/string.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <iterator>
 #include <map>
 #include <numeric>
 #include <stdexcept>
+#include <utility>
+
+namespace meld::detail {
+  // Level types form a tree that mirrors the level hierarchy.  The children of each type
+  // are kept in a singly-linked list to which new types are prepended with a
+  // compare-and-swap, so that looking up (or adding) a child type never takes a lock.
+  // Level types are never destroyed.
+  struct level_type {
+    level_type(std::string level_name, std::size_t level_hash) :
+      name{std::move(level_name)}, hash{level_hash}
+    {
+    }
+
+    level_type const& child(std::string const& child_name) const
+    {
+      auto* head = children.load(std::memory_order_acquire);
+      if (auto const* found = find(head, nullptr, child_name)) {
+        return *found;
+      }
+
+      auto* candidate = new level_type{child_name, meld::hash(hash, child_name)};
+      candidate->next = head;
+      while (not children.compare_exchange_weak(
+        candidate->next, candidate, std::memory_order_release, std::memory_order_acquire)) {
+        // Only the types added since the last attempt need to be searched.
+        if (auto const* found = find(candidate->next, head, child_name)) {
+          delete candidate;
+          return *found;
+        }
+        head = candidate->next;
+      }
+      return *candidate;
+    }
+
+    std::string const name;
+    std::size_t const hash;
+
+  private:
+    // Searches the list from 'first' up to (but excluding) 'last'
+    static level_type const* find(level_type const* first,
+                                  level_type const* last,
+                                  std::string const& child_name)
+    {
+      for (auto const* type = first; type != last; type = type->next) {
+        if (type->name == child_name) {
+          return type;
+        }
+      }
+      return nullptr;
+    }
+
+    mutable std::atomic<level_type const*> children{nullptr};
+    level_type const* next{nullptr};
+  };
+}
 
 namespace {
+  using meld::detail::level_type;
 
-  std::vector<std::size_t> all_numbers(meld::level_id const& id)
+  level_type const& job_level_type()
   {
-    if (!id.has_parent()) {
-      return {};
-    }
+    static level_type const job{"job", meld::hash("job")};
+    return job;
+  }
 
-    auto const* current = &id;
-    std::vector<std::size_t> result(id.depth());
-    for (std::size_t i = id.depth(); i > 0; --i) {
-      result[i - 1] = current->number();
-      current = current->parent().get();
+  // Lexicographically compares the level numbers of two IDs at the same depth, starting
+  // from the base ID (which does not contribute a number).
+  int compare_numbers(meld::level_id const* a, meld::level_id const* b)
+  {
+    if (a == b or not a->has_parent()) {
+      return 0;
     }
-    return result;
+    if (auto const result = compare_numbers(a->parent().get(), b->parent().get()); result != 0) {
+      return result;
+    }
+    return a->number() < b->number() ? -1 : (a->number() > b->number() ? 1 : 0);
   }
 
+  meld::level_id const* ancestor_at(meld::level_id const* id, std::size_t const depth)
+  {
+    while (id->depth() > depth) {
+      id = id->parent().get();
+    }
+    return id;
+  }
 }
 
 namespace meld {
 
-  level_id::level_id() : level_name_{"job"}, level_hash_{meld::hash(level_name_)} {}
+  level_id::level_id() : type_{&job_level_type()} {}
 
-  level_id::level_id(level_id_ptr parent, std::size_t i, std::string level_name) :
+  level_id::level_id(level_id_ptr parent, std::size_t i, level_type const& type) :
     parent_{std::move(parent)},
+    type_{&type},
     number_{i},
-    level_name_{std::move(level_name)},
-    level_hash_{meld::hash(parent_->level_hash_, level_name_)},
-    depth_{parent_->depth_ + 1},
-    hash_{meld::hash(parent_->hash_, number_, level_hash_)}
+    hash_{meld::hash(parent_->hash_, number_, type_->hash)},
+    depth_{parent_->depth_ + 1}
   {
     // FIXME: Should it be an error to create an ID with an empty name?
   }
@@ -51,39 +118,47 @@ namespace meld {
     return base_id;
   }
 
-  std::string const& level_id::level_name() const noexcept { return level_name_; }
+  std::string const& level_id::level_name() const noexcept { return type_->name; }
   std::size_t level_id::depth() const noexcept { return depth_; }
 
   level_id_ptr level_id::make_child(std::size_t const new_level_number,
-                                    std::string new_level_name) const
+                                    std::string const& new_level_name) const
   {
     return level_id_ptr{
-      new level_id{shared_from_this(), new_level_number, std::move(new_level_name)}};
+      new level_id{shared_from_this(), new_level_number, type_->child(new_level_name)}};
   }
 
   bool level_id::has_parent() const noexcept { return static_cast<bool>(parent_); }
 
   std::size_t level_id::number() const { return number_; }
   std::size_t level_id::hash() const noexcept { return hash_; }
-  std::size_t level_id::level_hash() const noexcept { return level_hash_; }
+  std::size_t level_id::level_hash() const noexcept { return type_->hash; }
 
   bool level_id::operator==(level_id const& other) const
   {
-    if (depth_ != other.depth_)
+    if (depth_ != other.depth_) {
       return false;
-    auto const same_numbers = number_ == other.number_;
-    if (not parent_) {
-      return same_numbers;
     }
-    return *parent_ == *other.parent_ && same_numbers;
+    for (auto const *a = this, *b = &other; a != b; a = a->parent_.get(), b = b->parent_.get()) {
+      if (a->number_ != b->number_) {
+        return false;
+      }
+      if (not a->parent_) {
+        break;
+      }
+    }
+    return true;
   }
 
   bool level_id::operator<(level_id const& other) const
   {
-    auto these_numbers = all_numbers(*this);
-    auto those_numbers = all_numbers(other);
-    return std::lexicographical_compare(
-      begin(these_numbers), end(these_numbers), begin(those_numbers), end(those_numbers));
+    auto const common_depth = std::min(depth_, other.depth_);
+    auto const result =
+      compare_numbers(ancestor_at(this, common_depth), ancestor_at(&other, common_depth));
+    if (result != 0) {
+      return result < 0;
+    }
+    return depth_ < other.depth_;
   }
 
   level_id_ptr id_for(std::vector<std::size_t> nums)
@@ -117,7 +192,7 @@ namespace meld {
   {
     level_id_ptr parent = parent_;
     while (parent) {
-      if (parent->level_name_ == level_name) {
+      if (parent->type_->name == level_name) {
         return parent;
       }
       parent = parent->parent_;
@@ -145,10 +220,10 @@ namespace meld {
 
   std::string level_id::to_string_this_level() const
   {
-    if (empty(level_name_)) {
+    if (empty(type_->name)) {
       return std::to_string(number_);
     }
-    return level_name_ + ":" + std::to_string(number_);
+    return type_->name + ":" + std::to_string(number_);
   }
 
   std::ostream& operator<<(std::ostream& os, level_id const& id) { return os << id.to_string(); }
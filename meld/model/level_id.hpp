@@ -14,13 +14,17 @@
 #include <vector>
 
 namespace meld {
+  namespace detail {
+    struct level_type;
+  }
+
   class level_id : public std::enable_shared_from_this<level_id> {
   public:
     static level_id const& base();
     static level_id_ptr base_ptr();
 
     using hash_type = std::size_t;
-    level_id_ptr make_child(std::size_t new_level_number, std::string level_name) const;
+    level_id_ptr make_child(std::size_t new_level_number, std::string const& level_name) const;
     std::string const& level_name() const noexcept;
     std::size_t depth() const noexcept;
     level_id_ptr parent(std::string const& level_name) const;
@@ -38,14 +42,19 @@ namespace meld {
     friend std::ostream& operator<<(std::ostream& os, level_id const& id);
 
   private:
+    // Level names are interned into a registry of level types, keyed by the level hash.
+    // Each level ID thus refers to its (immutable) level type instead of owning a copy of
+    // the level name.
+    using level_type = detail::level_type;
+
     level_id();
-    explicit level_id(level_id_ptr parent, std::size_t i, std::string level_name);
+    explicit level_id(level_id_ptr parent, std::size_t i, level_type const& type);
+
     level_id_ptr parent_{nullptr};
+    level_type const* type_;
     std::size_t number_{-1ull};
-    std::string level_name_;
-    std::size_t level_hash_;
-    std::size_t depth_{};
     hash_type hash_{0};
+    std::size_t depth_{};
   };
 
   level_id_ptr id_for(char const* str);
@@ -0,0 +1,50 @@
+#ifndef meld_model_owned_hpp
+#define meld_model_owned_hpp
+
+// =======================================================================================
+// An algorithm that modifies its input (e.g. to publish a calibrated version of it) may
+// declare the corresponding parameter as owned<T>.  If the algorithm is the only
+// consumer of the product, the product is moved out of its store and handed over to the
+// algorithm; otherwise, the algorithm receives a copy of the product.
+//
+// A product that has been handed over is left in a valid but unspecified state, and it
+// must not be read by any other node.  The framework guarantees this by handing over a
+// product only when (a) no other node consumes it, (b) no output nodes are registered,
+// and (c) the store that contains the product is not shared by later invocations of the
+// algorithm (i.e. it is the most-derived store of the algorithm's input messages).
+// =======================================================================================
+
+#include <type_traits>
+#include <utility>
+
+namespace meld {
+  template <typename T>
+  class owned {
+  public:
+    using value_type = T;
+
+    explicit owned(T const& t) : obj_{t} {}
+    explicit owned(T&& t) : obj_{std::move(t)} {}
+
+    T& operator*() noexcept { return obj_; }
+    T const& operator*() const noexcept { return obj_; }
+    T* operator->() noexcept { return &obj_; }
+    T const* operator->() const noexcept { return &obj_; }
+
+    T release() && { return std::move(obj_); }
+
+  private:
+    T obj_;
+  };
+
+  template <typename T>
+  struct is_owned : std::false_type {};
+
+  template <typename T>
+  struct is_owned<owned<T>> : std::true_type {};
+
+  template <typename T>
+  constexpr bool is_owned_v = is_owned<std::remove_cvref_t<T>>::value;
+}
+
+#endif // meld_model_owned_hpp
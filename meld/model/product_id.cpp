@@ -0,0 +1,56 @@
+#include "meld/model/product_id.hpp"
+
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace {
+  class product_names {
+  public:
+    std::size_t intern(std::string const& name)
+    {
+      {
+        std::shared_lock lock{mutex_};
+        if (auto it = indices_.find(name); it != indices_.end()) {
+          return it->second;
+        }
+      }
+      std::unique_lock lock{mutex_};
+      auto [it, inserted] = indices_.try_emplace(name, size(names_));
+      if (inserted) {
+        names_.push_back(name);
+      }
+      return it->second;
+    }
+
+    std::string const& name(std::size_t const index) const
+    {
+      std::shared_lock lock{mutex_};
+      return names_[index];
+    }
+
+  private:
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, std::size_t> indices_{{"", 0ull}};
+    std::deque<std::string> names_{""}; // Addresses of names must be stable
+  };
+
+  product_names& registry()
+  {
+    static product_names names;
+    return names;
+  }
+}
+
+namespace meld {
+  product_id::product_id(std::string const& product_name) :
+    index_{registry().intern(product_name)}
+  {
+  }
+
+  std::string const& product_id::name() const { return registry().name(index_); }
+
+  std::ostream& operator<<(std::ostream& os, product_id const& id) { return os << id.name(); }
+}
@@ -0,0 +1,33 @@
+#ifndef meld_model_product_id_hpp
+#define meld_model_product_id_hpp
+
+// =======================================================================================
+// Product names are interned so that a product can be identified by a small integer
+// instead of by its (fully-qualified) name.  Nodes resolve the ids of the products they
+// read and create when they are registered; looking up a product by its id then requires
+// neither allocating nor hashing a string.
+// =======================================================================================
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+namespace meld {
+  class product_id {
+  public:
+    product_id() = default;
+    explicit product_id(std::string const& product_name);
+
+    std::string const& name() const;
+    std::size_t index() const noexcept { return index_; }
+
+    bool operator==(product_id const& other) const noexcept = default;
+
+  private:
+    std::size_t index_{};
+  };
+
+  std::ostream& operator<<(std::ostream& os, product_id const& id);
+}
+
+#endif // meld_model_product_id_hpp
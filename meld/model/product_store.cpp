@@ -1,7 +1,12 @@
 #include "meld/model/product_store.hpp"
+#include "meld/model/level_counter.hpp"
 #include "meld/model/level_id.hpp"
+#include "meld/utilities/hashing.hpp"
+
+#include "boost/container/small_vector.hpp"
 
 #include <memory>
+#include <ranges>
 #include <utility>
 
 namespace meld {
@@ -62,9 +67,10 @@ namespace meld {
 
   product_store_const_ptr product_store::store_for_product(std::string const& product_name) const
   {
+    product_id const id{product_name};
     auto store = shared_from_this();
     while (store != nullptr) {
-      if (store->contains_product(product_name)) {
+      if (store->contains_product(id)) {
         return store;
       }
       store = store->parent_;
@@ -74,7 +80,9 @@ namespace meld {
 
   product_store_ptr product_store::make_flush() const
   {
-    return product_store_ptr{new product_store{parent_, id_, "[inserted]", stage::flush}};
+    product_store_ptr result{new product_store{parent_, id_, "[inserted]", stage::flush}};
+    result->declared_child_counts_ = declared_child_counts_;
+    return result;
   }
 
   product_store_ptr product_store::make_continuation(std::string_view source,
@@ -108,11 +116,56 @@ namespace meld {
   level_id_ptr const& product_store::id() const noexcept { return id_; }
   bool product_store::is_flush() const noexcept { return stage_ == stage::flush; }
 
+  store_layout const* product_store::layout() const
+  {
+    if (auto const* result = layout_.load(std::memory_order_acquire)) {
+      return result;
+    }
+    auto const* parent_layout = parent_ ? parent_->layout() : nullptr;
+    boost::container::small_vector<std::size_t, 8> product_indices;
+    for (auto const& [id, _] : products_) {
+      product_indices.push_back(id.index());
+    }
+    // Concurrent callers intern the same layout, so whichever stores it last is harmless.
+    auto const* result = store_layout::intern(
+      parent_layout, level_name(), {product_indices.data(), product_indices.size()});
+    layout_.store(result, std::memory_order_release);
+    return result;
+  }
+
+  flush_counts_ptr const& product_store::declared_child_counts() const noexcept
+  {
+    return declared_child_counts_;
+  }
+
+  void product_store::declare_child_counts(std::map<std::string, std::size_t> const& counts)
+  {
+    std::map<level_id::hash_type, std::size_t> child_counts;
+    for (auto const& [level_path, count] : counts) {
+      auto level_hash = id_->level_hash();
+      for (auto const level_name : level_path | std::views::split('/')) {
+        level_hash = hash(level_hash, std::string(level_name.begin(), level_name.end()));
+      }
+      child_counts.emplace(level_hash, count);
+    }
+    declared_child_counts_ = std::make_shared<flush_counts const>(std::move(child_counts));
+  }
+
   bool product_store::contains_product(std::string const& product_name) const
   {
     return products_.contains(product_name);
   }
 
+  bool product_store::contains_product(product_id const id) const
+  {
+    return products_.contains(id);
+  }
+
+  void product_store::finished_with(product_id const id, std::size_t const consumers) const
+  {
+    products_.finished_with(id, consumers);
+  }
+
   product_store_ptr const& more_derived(product_store_ptr const& a, product_store_ptr const& b)
   {
     if (a->id()->depth() > b->id()->depth()) {
@@ -5,8 +5,10 @@
 #include "meld/model/handle.hpp"
 #include "meld/model/level_id.hpp"
 #include "meld/model/products.hpp"
+#include "meld/model/store_layout.hpp"
 
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include <map>
 #include <memory>
@@ -42,8 +44,19 @@ namespace meld {
     level_id_ptr const& id() const noexcept;
     bool is_flush() const noexcept;
 
+    // The layout of this store and its parents, computed the first time it is requested.
+    // It may be requested only once all of the store's products have been added.
+    store_layout const* layout() const;
+
+    // The numbers of nested stores declared by the source (null if none have been declared)
+    flush_counts_ptr const& declared_child_counts() const noexcept;
+
     // Product interface
     bool contains_product(std::string const& key) const;
+    bool contains_product(product_id id) const;
+
+    // See products::finished_with
+    void finished_with(product_id id, std::size_t consumers) const;
 
     template <typename T>
     T const& get_product(std::string const& key) const;
@@ -51,6 +64,9 @@ namespace meld {
     template <typename T>
     handle<T> get_handle(std::string const& key) const;
 
+    template <typename T>
+    handle<T> get_handle(product_id id) const;
+
     // Thread-unsafe operations
     template <typename T>
     void add_product(std::string const& key, T&& t);
@@ -58,6 +74,17 @@ namespace meld {
     template <typename T>
     void add_product(std::string const& key, std::shared_ptr<product<T>>&& t);
 
+    // Constructs the product in place from the arguments (e.g. for move-only types)
+    template <typename T, typename... Args>
+    void emplace_product(std::string const& key, Args&&... args);
+
+    // Declares the number of stores nested within this one, keyed by the path of their
+    // level relative to this store (e.g. "subrun" and "subrun/event").  The framework then
+    // does not count the nested stores when flushing this store, and reductions over this
+    // store complete as soon as its last nested store has been processed.  The counts must
+    // therefore include each nested level.
+    void declare_child_counts(std::map<std::string, std::size_t> const& counts);
+
   private:
     explicit product_store(product_store_const_ptr parent = nullptr,
                            level_id_ptr id = level_id::base_ptr(),
@@ -80,6 +107,8 @@ namespace meld {
     level_id_ptr id_;
     std::string_view source_;
     stage stage_;
+    flush_counts_ptr declared_child_counts_{nullptr};
+    mutable std::atomic<store_layout const*> layout_{nullptr};
   };
 
   product_store_ptr const& more_derived(product_store_ptr const& a, product_store_ptr const& b);
@@ -113,7 +142,7 @@ namespace meld {
   template <typename T>
   void product_store::add_product(std::string const& key, T&& t)
   {
-    add_product(key, std::make_shared<product<std::remove_cvref_t<T>>>(std::forward<T>(t)));
+    products_.add(key, std::forward<T>(t));
   }
 
   template <typename T>
@@ -122,12 +151,24 @@ namespace meld {
     products_.add(key, std::move(t));
   }
 
+  template <typename T, typename... Args>
+  void product_store::emplace_product(std::string const& key, Args&&... args)
+  {
+    products_.emplace<T>(product_id{key}, std::forward<Args>(args)...);
+  }
+
   template <typename T>
   [[nodiscard]] handle<T> product_store::get_handle(std::string const& key) const
   {
     return handle<T>{products_.get<T>(key), *id_};
   }
 
+  template <typename T>
+  [[nodiscard]] handle<T> product_store::get_handle(product_id const id) const
+  {
+    return handle<T>{products_.get<T>(id), *id_};
+  }
+
   template <typename T>
   [[nodiscard]] T const& product_store::get_product(std::string const& key) const
   {
@@ -0,0 +1,52 @@
+#ifndef meld_model_product_view_hpp
+#define meld_model_product_view_hpp
+
+// =======================================================================================
+// A splitter may create children whose products are non-owning views into a (contiguous)
+// product of the parent store, instead of copies of the parent's data:
+//
+//   product_view<float> element(std::size_t i) const
+//   {
+//     return product_view<float>{waveform_}.subspan(i * slice_size, slice_size);
+//   }
+//
+// The viewed product is kept alive by the child stores, each of which refers to its parent
+// store.  A splitter that creates views does not release the payloads of its input
+// products once it has run; they are destroyed together with their store.
+// =======================================================================================
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+namespace meld {
+  template <typename T>
+  using product_view = std::span<T const>;
+
+  template <typename T>
+  struct is_product_view : std::false_type {};
+
+  template <typename T, std::size_t Extent>
+  struct is_product_view<std::span<T const, Extent>> : std::true_type {};
+
+  template <typename Char, typename Traits>
+  struct is_product_view<std::basic_string_view<Char, Traits>> : std::true_type {};
+
+  template <typename T>
+  constexpr bool is_product_view_v = is_product_view<std::remove_cvref_t<T>>::value;
+
+  // True if T is a product view, or a tuple that contains at least one product view
+  template <typename T>
+  struct contains_product_views : is_product_view<T> {};
+
+  template <typename... Ts>
+  struct contains_product_views<std::tuple<Ts...>> : std::disjunction<is_product_view<Ts>...> {};
+
+  template <typename T>
+  constexpr bool contains_product_views_v =
+    contains_product_views<std::remove_cvref_t<T>>::value;
+}
+
+#endif // meld_model_product_view_hpp
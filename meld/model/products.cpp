@@ -1,11 +1,26 @@
 #include "meld/model/products.hpp"
 
+#include <algorithm>
 #include <string>
 
 namespace meld {
   bool products::contains(std::string const& product_name) const
   {
-    return products_.contains(product_name);
+    return contains(product_id{product_name});
+  }
+
+  bool products::contains(product_id const id) const { return find(id) != cend(products_); }
+
+  void products::finished_with(product_id const id, std::size_t const consumers) const
+  {
+    if (auto it = find(id); it != cend(products_) and it->second->finished_with(consumers)) {
+      it->second->release();
+    }
+  }
+
+  products::const_iterator products::find(product_id const id) const
+  {
+    return std::ranges::find(products_, id, [](auto const& entry) { return entry.first; });
   }
 
   products::const_iterator products::begin() const noexcept { return products_.begin(); }
@@ -2,37 +2,83 @@
 #define meld_model_products_hpp
 
 #include "meld/model/level_id.hpp"
+#include "meld/model/product_id.hpp"
 #include "meld/model/qualified_name.hpp"
 
 #include "boost/core/demangle.hpp"
 #include "spdlog/spdlog.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <tuple>
+#include <type_traits>
 #include <typeindex>
-#include <unordered_map>
+#include <typeinfo>
 #include <utility>
 #include <variant>
+#include <vector>
 
 namespace meld {
 
   struct product_base {
+    explicit product_base(std::type_info const& type) : type_info{type} {}
     virtual ~product_base() = default;
     virtual void const* address() const = 0;
-    virtual std::type_index type() const = 0;
+    std::type_index type() const { return std::type_index{type_info}; }
+
+    // Returns true for the last of the product's consumers to finish with it
+    bool finished_with(std::size_t const consumers) noexcept { return ++uses_ == consumers; }
+
+    // Frees the resources held by the product object, which remains a valid object
+    virtual void release() noexcept = 0;
+
+    std::type_info const& type_info;
+
+  private:
+    std::atomic<std::size_t> uses_{};
   };
 
   template <typename T>
   struct product : product_base {
-    explicit product(T const& prod) : obj{prod} {}
+    using value_type = std::remove_cvref_t<T>;
+
+    explicit product(T const& prod) : product_base{typeid(T)}, obj{prod} {}
+    explicit product(T&& prod) : product_base{typeid(T)}, obj{std::move(prod)} {}
+    template <typename... Args>
+    explicit product(std::in_place_t, Args&&... args) :
+      product_base{typeid(T)}, obj(std::forward<Args>(args)...)
+    {
+    }
     void const* address() const final { return &obj; }
-    virtual std::type_index type() const { return std::type_index{typeid(T)}; }
-    std::remove_cvref_t<T> obj;
+    void release() noexcept final
+    {
+      // Products that cannot be reset to an empty state are kept until they are destroyed
+      if constexpr (std::is_nothrow_default_constructible_v<value_type> and
+                    std::is_nothrow_move_assignable_v<value_type>) {
+        obj = value_type{};
+      }
+    }
+    value_type obj;
   };
 
+  template <std::size_t N>
+  std::array<product_id, N> to_product_ids(std::array<qualified_name, N> const& names)
+  {
+    std::array<product_id, N> result;
+    std::ranges::transform(names, result.begin(), [](auto const& name) {
+      return product_id{name.full()};
+    });
+    return result;
+  }
+
+  // A store holds only a few products, which are searched linearly by product ID.
   class products {
-    using collection_t = std::unordered_map<std::string, std::shared_ptr<product_base>>;
+    using collection_t = std::vector<std::pair<product_id, std::shared_ptr<product_base>>>;
 
   public:
     using const_iterator = collection_t::const_iterator;
@@ -40,35 +86,63 @@ namespace meld {
     template <typename T>
     void add(std::string const& product_name, T&& t)
     {
-      add(product_name, std::make_shared<product<std::remove_cvref_t<T>>>(std::forward<T>(t)));
+      add(product_id{product_name}, std::forward<T>(t));
     }
 
     template <typename T>
-    void add(std::string const& product_name, std::shared_ptr<product<T>>&& t)
+    void add(product_id const id, T&& t)
     {
-      products_.emplace(product_name, std::move(t));
+      add(id, std::make_shared<product<std::remove_cvref_t<T>>>(std::forward<T>(t)));
+    }
+
+    template <typename T>
+    void add(product_id const id, std::shared_ptr<product<T>>&& t)
+    {
+      if (find(id) == cend(products_)) {
+        products_.emplace_back(id, std::move(t));
+      }
+    }
+
+    template <typename T, typename... Args>
+    void emplace(product_id const id, Args&&... args)
+    {
+      add(id, std::make_shared<product<T>>(std::in_place, std::forward<Args>(args)...));
     }
 
     template <typename Ts>
-    void add_all(std::array<qualified_name, 1> names, Ts&& ts)
+    void add_all(std::array<product_id, 1> ids, Ts&& ts)
+    {
+      add(ids[0], std::forward<Ts>(ts));
+    }
+
+    template <typename... Ts>
+    void add_all(std::array<product_id, sizeof...(Ts)> ids, std::tuple<Ts...> const& ts)
     {
-      add(names[0].full(), std::forward<Ts>(ts));
+      [this, &ids, &ts]<std::size_t... Is>(std::index_sequence<Is...>) {
+        (this->add(ids[Is], std::get<Is>(ts)), ...);
+      }(std::index_sequence_for<Ts...>{});
     }
 
     template <typename... Ts>
-    void add_all(std::array<qualified_name, sizeof...(Ts)> names, std::tuple<Ts...> ts)
+    void add_all(std::array<product_id, sizeof...(Ts)> ids, std::tuple<Ts...>&& ts)
     {
-      [this, &names]<std::size_t... Is>(auto const& ts, std::index_sequence<Is...>) {
-        (this->add(names[Is].full(), std::get<Is>(ts)), ...);
-      }(ts, std::index_sequence_for<Ts...>{});
+      [this, &ids, &ts]<std::size_t... Is>(std::index_sequence<Is...>) {
+        (this->add(ids[Is], std::get<Is>(std::move(ts))), ...);
+      }(std::index_sequence_for<Ts...>{});
     }
 
     template <typename T>
     std::variant<T const*, std::string> get(std::string const& product_name) const
     {
-      auto it = products_.find(product_name);
+      return get<T>(product_id{product_name});
+    }
+
+    template <typename T>
+    std::variant<T const*, std::string> get(product_id const id) const
+    {
+      auto it = find(id);
       if (it == cend(products_)) {
-        return "No product exists with the name '" + product_name + "'.";
+        return "No product exists with the name '" + id.name() + "'.";
       }
 
       // Should be able to use dynamic_cast a la:
@@ -80,20 +154,31 @@ namespace meld {
       // Unfortunately, this doesn't work well whenever products are inserted across
       // modules and shared object libraries.
 
+      // The type names are compared only if the type_info objects are distinct, which
+      // happens only when the product was created in a different shared library.
       auto available_product = it->second.get();
-      if (std::strcmp(typeid(T).name(), available_product->type().name()) == 0) {
+      auto const& available_type = available_product->type_info;
+      if (&typeid(T) == &available_type or
+          std::strcmp(typeid(T).name(), available_type.name()) == 0) {
         return &reinterpret_cast<product<T> const*>(available_product)->obj;
       }
-      return "Cannot get product '" + product_name + "' with type '" +
+      return "Cannot get product '" + id.name() + "' with type '" +
              boost::core::demangle(typeid(T).name()) + "' -- must specify type '" +
-             boost::core::demangle(available_product->type().name()) + "'.";
+             boost::core::demangle(available_type.name()) + "'.";
     }
 
+    // Called by each of the product's consumers once it has finished with the product.
+    // The last of them releases the product's payload (see product_base::release).
+    void finished_with(product_id id, std::size_t consumers) const;
+
     bool contains(std::string const& product_name) const;
+    bool contains(product_id id) const;
     const_iterator begin() const noexcept;
     const_iterator end() const noexcept;
 
   private:
+    const_iterator find(product_id id) const;
+
     collection_t products_;
   };
 }
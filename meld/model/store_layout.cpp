@@ -0,0 +1,88 @@
+#include "meld/model/store_layout.hpp"
+#include "meld/utilities/hashing.hpp"
+
+#include "oneapi/tbb/concurrent_unordered_set.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+  using meld::store_layout;
+
+  // The lookup key refers to the caller's data, so that a layout that has already been
+  // interned can be found without allocating.
+  struct layout_key {
+    store_layout const* parent;
+    std::string const& level_name;
+    std::span<std::size_t const> product_indices;
+    std::size_t hash;
+  };
+
+  struct layout_equal {
+    using is_transparent = void;
+    static bool equal(store_layout const& layout, layout_key const& key)
+    {
+      return layout.parent() == key.parent and layout.level_name() == key.level_name and
+             std::ranges::equal(layout.product_indices(), key.product_indices);
+    }
+    bool operator()(store_layout const& a, store_layout const& b) const
+    {
+      return equal(a, {b.parent(), b.level_name(), b.product_indices(), b.hash()});
+    }
+    bool operator()(store_layout const& a, layout_key const& b) const { return equal(a, b); }
+    bool operator()(layout_key const& a, store_layout const& b) const { return equal(b, a); }
+  };
+
+  struct layout_hasher {
+    using transparent_key_equal = layout_equal;
+    std::size_t operator()(store_layout const& layout) const noexcept { return layout.hash(); }
+    std::size_t operator()(layout_key const& key) const noexcept { return key.hash; }
+  };
+
+  // Elements of a concurrent unordered set are never relocated, and they are not erased,
+  // so the addresses of the interned layouts are stable.
+  using layouts_t = tbb::concurrent_unordered_set<store_layout, layout_hasher, layout_equal>;
+
+  layouts_t& layouts()
+  {
+    static layouts_t result;
+    return result;
+  }
+}
+
+namespace meld {
+  store_layout::store_layout(store_layout const* parent,
+                             std::string level_name,
+                             std::vector<std::size_t> product_indices,
+                             std::size_t const hash) :
+    parent_{parent},
+    level_name_{std::move(level_name)},
+    product_indices_{std::move(product_indices)},
+    hash_{hash}
+  {
+  }
+
+  store_layout const* store_layout::intern(store_layout const* parent,
+                                           std::string const& level_name,
+                                           std::span<std::size_t> product_indices)
+  {
+    std::ranges::sort(product_indices);
+    auto hash = meld::hash(parent ? parent->hash() : 0ull, level_name);
+    for (auto const index : product_indices) {
+      hash = meld::hash(hash, index);
+    }
+
+    auto& all = layouts();
+    layout_key const key{parent, level_name, product_indices, hash};
+    if (auto it = all.find(key); it != all.end()) {
+      return &*it;
+    }
+    // If two threads simultaneously intern the same layout, only one is inserted.
+    return &*all
+               .emplace(parent,
+                        level_name,
+                        std::vector<std::size_t>(product_indices.begin(), product_indices.end()),
+                        hash)
+               .first;
+  }
+}
@@ -0,0 +1,43 @@
+#ifndef meld_model_store_layout_hpp
+#define meld_model_store_layout_hpp
+
+// =======================================================================================
+// A store layout describes the level hierarchy of a product store together with the IDs
+// of the products held by the store and by each of its parents.  Layouts are interned:
+// two stores have the same layout if, and only if, they refer to the same layout object.
+// A layout can thus be used as an exact (collision-free) key for decisions that depend
+// only on which products are present where (e.g. the routes of the multiplexer).
+// =======================================================================================
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace meld {
+  class store_layout {
+  public:
+    // The product indices need not be sorted.
+    static store_layout const* intern(store_layout const* parent,
+                                      std::string const& level_name,
+                                      std::span<std::size_t> product_indices);
+
+    store_layout const* parent() const noexcept { return parent_; }
+    std::string const& level_name() const noexcept { return level_name_; }
+    std::vector<std::size_t> const& product_indices() const noexcept { return product_indices_; }
+    std::size_t hash() const noexcept { return hash_; }
+
+    store_layout(store_layout const* parent,
+                 std::string level_name,
+                 std::vector<std::size_t> product_indices,
+                 std::size_t hash);
+
+  private:
+    store_layout const* parent_;
+    std::string level_name_;
+    std::vector<std::size_t> product_indices_; // Sorted
+    std::size_t hash_;
+  };
+}
+
+#endif // meld_model_store_layout_hpp
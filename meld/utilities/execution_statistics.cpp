@@ -0,0 +1,123 @@
+#include "meld/utilities/execution_statistics.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <functional>
+
+#include <time.h>
+
+using namespace std::chrono;
+
+namespace {
+  std::atomic<bool> statistics_enabled{false};
+
+  nanoseconds thread_cpu_time() noexcept
+  {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return seconds{ts.tv_sec} + nanoseconds{ts.tv_nsec};
+  }
+
+  // The bins are arranged such that each power of two is split into four bins of equal
+  // width.  Values smaller than 4 ns do not need all four bins of their octave.
+  std::size_t bin_for(std::uint64_t const ns) noexcept
+  {
+    if (ns == 0ull) {
+      return 0ull;
+    }
+    std::size_t const octave = std::bit_width(ns) - 1;
+    std::size_t const sub_bin =
+      octave >= 2 ? (ns >> (octave - 2)) & 0x3 : (ns << (2 - octave)) & 0x3;
+    return octave * 4 + sub_bin;
+  }
+
+  std::uint64_t upper_edge_of(std::size_t const bin) noexcept
+  {
+    auto const next = bin + 1;
+    std::size_t const octave = next / 4;
+    std::uint64_t const mantissa = 4 + next % 4;
+    return octave >= 2 ? mantissa << (octave - 2) : mantissa >> (2 - octave);
+  }
+}
+
+namespace meld {
+  void enable_execution_statistics(bool const enable) noexcept { statistics_enabled = enable; }
+  bool execution_statistics_enabled() noexcept
+  {
+    return statistics_enabled.load(std::memory_order_relaxed);
+  }
+
+  execution_statistics::sentry::sentry(execution_statistics& stats) noexcept :
+    stats_{execution_statistics_enabled() ? &stats : nullptr}
+  {
+    if (stats_) {
+      begin_wall_ = steady_clock::now();
+      begin_cpu_ = thread_cpu_time();
+    }
+  }
+
+  execution_statistics::sentry::~sentry()
+  {
+    if (not stats_) {
+      return;
+    }
+    auto const wall = duration_cast<nanoseconds>(steady_clock::now() - begin_wall_);
+    stats_->record(wall, thread_cpu_time() - begin_cpu_);
+  }
+
+  void execution_statistics::record(nanoseconds const wall, nanoseconds const cpu) noexcept
+  {
+    auto const wall_ns = wall.count();
+    auto& acc = accumulators_.local();
+    ++acc.count;
+    acc.total_wall += wall_ns;
+    acc.total_cpu += cpu.count();
+    acc.min_wall = std::min(acc.min_wall, wall_ns);
+    acc.max_wall = std::max(acc.max_wall, wall_ns);
+    ++acc.histogram[bin_for(static_cast<std::uint64_t>(std::max<std::int64_t>(wall_ns, 0)))];
+  }
+
+  void execution_statistics::accumulator::merge(accumulator const& other) noexcept
+  {
+    count += other.count;
+    total_wall += other.total_wall;
+    total_cpu += other.total_cpu;
+    min_wall = std::min(min_wall, other.min_wall);
+    max_wall = std::max(max_wall, other.max_wall);
+    std::ranges::transform(histogram, other.histogram, histogram.begin(), std::plus{});
+  }
+
+  nanoseconds execution_statistics::accumulator::percentile(double const fraction) const
+  {
+    auto const threshold = static_cast<std::size_t>(std::ceil(fraction * count));
+    std::size_t cumulative{};
+    for (std::size_t bin = 0; bin != n_bins; ++bin) {
+      cumulative += histogram[bin];
+      if (cumulative >= threshold) {
+        auto const edge = static_cast<std::int64_t>(upper_edge_of(bin));
+        return nanoseconds{std::clamp(edge, min_wall, max_wall)};
+      }
+    }
+    return nanoseconds{max_wall};
+  }
+
+  execution_summary execution_statistics::summary() const
+  {
+    accumulator total;
+    for (auto const& acc : accumulators_) {
+      total.merge(acc);
+    }
+    if (total.count == 0ull) {
+      return {};
+    }
+    return {.count = total.count,
+            .total_wall = nanoseconds{total.total_wall},
+            .total_cpu = nanoseconds{total.total_cpu},
+            .min_wall = nanoseconds{total.min_wall},
+            .max_wall = nanoseconds{total.max_wall},
+            .p50_wall = total.percentile(0.50),
+            .p99_wall = total.percentile(0.99)};
+  }
+}
@@ -0,0 +1,85 @@
+#ifndef meld_utilities_execution_statistics_hpp
+#define meld_utilities_execution_statistics_hpp
+
+// =======================================================================================
+// The execution_statistics class accumulates the wall-clock and CPU times of repeated
+// invocations of a function, which may occur concurrently on different threads.  An
+// invocation is timed by creating a sentry object before the call, whose destructor
+// records the elapsed times:
+//
+//   {
+//     auto const sentry = stats.time();
+//     f();
+//   }
+//
+// In addition to the count, the totals, the minimum and the maximum wall-clock times,
+// the wall-clock times are recorded in a logarithmic histogram with four bins per
+// power of two, from which the approximate median and 99th percentile are determined.
+//
+// Each thread accumulates its invocations separately, so that recording requires no
+// synchronization.  The summary combines the threads' accumulations; it must therefore
+// be requested only once the timed invocations have completed.
+//
+// Timing is disabled by default (see enable_execution_statistics), in which case a
+// sentry does not read any clocks and nothing is recorded.
+// =======================================================================================
+
+#include "oneapi/tbb/enumerable_thread_specific.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace meld {
+  void enable_execution_statistics(bool enable = true) noexcept;
+  bool execution_statistics_enabled() noexcept;
+
+  struct execution_summary {
+    std::size_t count{};
+    std::chrono::nanoseconds total_wall{};
+    std::chrono::nanoseconds total_cpu{};
+    std::chrono::nanoseconds min_wall{};
+    std::chrono::nanoseconds max_wall{};
+    std::chrono::nanoseconds p50_wall{};
+    std::chrono::nanoseconds p99_wall{};
+  };
+
+  class execution_statistics {
+  public:
+    class sentry {
+    public:
+      explicit sentry(execution_statistics& stats) noexcept;
+      ~sentry();
+
+    private:
+      execution_statistics* stats_; // Null if timing is disabled
+      std::chrono::steady_clock::time_point begin_wall_;
+      std::chrono::nanoseconds begin_cpu_;
+    };
+
+    sentry time() noexcept { return sentry{*this}; }
+    void record(std::chrono::nanoseconds wall, std::chrono::nanoseconds cpu) noexcept;
+    execution_summary summary() const;
+
+  private:
+    static constexpr std::size_t bins_per_octave{4};
+    static constexpr std::size_t n_bins{64 * bins_per_octave};
+
+    struct accumulator {
+      std::size_t count{};
+      std::int64_t total_wall{};
+      std::int64_t total_cpu{};
+      std::int64_t min_wall{INT64_MAX};
+      std::int64_t max_wall{};
+      std::array<std::size_t, n_bins> histogram{};
+
+      void merge(accumulator const& other) noexcept;
+      std::chrono::nanoseconds percentile(double fraction) const;
+    };
+
+    tbb::enumerable_thread_specific<accumulator> accumulators_;
+  };
+}
+
+#endif // meld_utilities_execution_statistics_hpp
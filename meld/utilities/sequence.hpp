@@ -0,0 +1,97 @@
+#ifndef meld_utilities_sequence_hpp
+#define meld_utilities_sequence_hpp
+
+// =======================================================================================
+// A sequence is a lazily evaluated C++20 coroutine that yields values of type T:
+//
+//   sequence<int> numbers(int n)
+//   {
+//     for (int i = 0; i != n; ++i) {
+//       co_yield i;
+//     }
+//   }
+//
+// The coroutine is resumed only when the next value is requested, and it must not be
+// resumed concurrently.
+// =======================================================================================
+
+#include <concepts>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace meld {
+  template <typename T>
+  class sequence {
+  public:
+    using value_type = T;
+
+    struct promise_type {
+      sequence get_return_object() { return sequence{handle_t::from_promise(*this)}; }
+      std::suspend_always initial_suspend() const noexcept { return {}; }
+      std::suspend_always final_suspend() const noexcept { return {}; }
+
+      template <typename U>
+        requires std::constructible_from<T, U&&>
+      std::suspend_always yield_value(U&& u)
+      {
+        value.emplace(std::forward<U>(u));
+        return {};
+      }
+
+      void return_void() const noexcept {}
+      void unhandled_exception() { exception = std::current_exception(); }
+
+      std::optional<T> value;
+      std::exception_ptr exception;
+    };
+
+    sequence(sequence&& other) noexcept : handle_{std::exchange(other.handle_, nullptr)} {}
+    sequence& operator=(sequence&& other) noexcept
+    {
+      std::swap(handle_, other.handle_);
+      return *this;
+    }
+    ~sequence()
+    {
+      if (handle_) {
+        handle_.destroy();
+      }
+    }
+
+    // Resumes the coroutine, returning false once it has finished.  Any exception thrown
+    // by the coroutine is rethrown.
+    bool next()
+    {
+      auto& promise = handle_.promise();
+      promise.value.reset();
+      handle_.resume();
+      if (promise.exception) {
+        std::rethrow_exception(std::exchange(promise.exception, nullptr));
+      }
+      return not handle_.done();
+    }
+
+    // Moves out the most recently yielded value
+    T take() { return std::move(*handle_.promise().value); }
+
+  private:
+    using handle_t = std::coroutine_handle<promise_type>;
+    explicit sequence(handle_t h) noexcept : handle_{h} {}
+
+    handle_t handle_;
+  };
+
+  template <typename T>
+  struct is_sequence : std::false_type {};
+
+  template <typename T>
+  struct is_sequence<sequence<T>> : std::true_type {};
+
+  template <typename T>
+  constexpr bool is_sequence_v = is_sequence<T>::value;
+}
+
+#endif // meld_utilities_sequence_hpp
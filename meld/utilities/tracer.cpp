@@ -0,0 +1,201 @@
+#include "meld/utilities/tracer.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+using namespace std::chrono;
+
+namespace {
+  struct event {
+    std::int64_t begin;
+    std::int64_t end;
+    meld::trace::name_t name;
+    meld::trace::category category;
+  };
+
+  // Each buffer is written only by the thread that owns it.  The buffers are read only
+  // when writing the trace file, by which time the recording threads are expected to be
+  // idle.
+  class thread_buffer {
+  public:
+    static constexpr std::size_t capacity{1 << 16};
+
+    explicit thread_buffer(std::size_t const index) : index_{index} {}
+
+    void push(event const& e) noexcept
+    {
+      auto const n = next_.load(std::memory_order_relaxed);
+      events_[n % capacity] = e;
+      next_.store(n + 1, std::memory_order_release);
+    }
+
+    template <typename F>
+    void for_each(F f) const
+    {
+      auto const n = next_.load(std::memory_order_acquire);
+      for (std::size_t i = n > capacity ? n - capacity : 0ull; i != n; ++i) {
+        f(events_[i % capacity]);
+      }
+    }
+
+    std::size_t index() const noexcept { return index_; }
+
+  private:
+    std::size_t index_;
+    std::atomic<std::size_t> next_{};
+    std::array<event, capacity> events_;
+  };
+
+  steady_clock::time_point epoch{steady_clock::now()};
+
+  std::mutex registry_mutex;
+  std::vector<std::unique_ptr<thread_buffer>> buffers;
+  std::vector<std::string> names;
+  std::unordered_map<std::string, meld::trace::name_t> name_ids;
+
+  thread_buffer& local_buffer()
+  {
+    thread_local thread_buffer* buffer = [] {
+      std::lock_guard lock{registry_mutex};
+      return buffers.emplace_back(std::make_unique<thread_buffer>(size(buffers))).get();
+    }();
+    return *buffer;
+  }
+
+  char const* to_string(meld::trace::category const c)
+  {
+    using meld::trace::category;
+    switch (c) {
+    case category::node:
+      return "node";
+    case category::multiplexer:
+      return "multiplexer";
+    case category::filter:
+      return "filter";
+    case category::flush:
+      return "flush";
+    }
+    return "unknown";
+  }
+
+  // Names are written as JSON strings, in which quotes, backslashes and control
+  // characters must be escaped.
+  std::string escaped(std::string const& str)
+  {
+    std::string result;
+    result.reserve(size(str));
+    for (char const c : str) {
+      switch (c) {
+      case '"':
+        result += "\\\"";
+        break;
+      case '\\':
+        result += "\\\\";
+        break;
+      case '\b':
+        result += "\\b";
+        break;
+      case '\f':
+        result += "\\f";
+        break;
+      case '\n':
+        result += "\\n";
+        break;
+      case '\r':
+        result += "\\r";
+        break;
+      case '\t':
+        result += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          result += fmt::format("\\u{:04x}", static_cast<unsigned int>(c));
+        }
+        else {
+          result += c;
+        }
+      }
+    }
+    return result;
+  }
+}
+
+namespace meld::trace {
+  namespace detail {
+    std::atomic<bool> enabled{false};
+
+    std::int64_t now() noexcept
+    {
+      return duration_cast<nanoseconds>(steady_clock::now() - epoch).count();
+    }
+
+    void record(category const c,
+                name_t const name,
+                std::int64_t const begin,
+                std::int64_t const end) noexcept
+    {
+      local_buffer().push({begin, end, name, c});
+    }
+  }
+
+  name_t register_name(std::string const& name)
+  {
+    std::lock_guard lock{registry_mutex};
+    auto [it, inserted] = name_ids.try_emplace(name, static_cast<name_t>(size(names)));
+    if (inserted) {
+      names.push_back(name);
+    }
+    return it->second;
+  }
+
+  void enable()
+  {
+#if !defined(MELD_ENABLE_TRACING)
+    spdlog::warn("Tracing was disabled at build time; no trace events will be recorded.");
+#endif
+    epoch = steady_clock::now();
+    detail::enabled = true;
+  }
+
+  void write_chrome_trace(std::string const& filename)
+  {
+    std::ofstream out{filename};
+    if (not out) {
+      throw std::runtime_error("Unable to open trace file '" + filename + "'.");
+    }
+
+    std::lock_guard lock{registry_mutex};
+    std::size_t n_events{};
+    out << "{\"traceEvents\":[";
+    char const* separator = "\n";
+    for (auto const& buffer : buffers) {
+      out << separator
+          << fmt::format(R"({{"name":"thread_name","ph":"M","pid":0,"tid":{0},)"
+                         R"("args":{{"name":"thread {0}"}}}})",
+                         buffer->index());
+      separator = ",\n";
+      buffer->for_each([&](event const& e) {
+        // Trace-event timestamps are expressed in microseconds.
+        out << separator
+            << fmt::format(
+                 R"({{"name":"{}","cat":"{}","ph":"X","pid":0,"tid":{},"ts":{:.3f},"dur":{:.3f}}})",
+                 escaped(names[e.name]),
+                 to_string(e.category),
+                 buffer->index(),
+                 e.begin / 1e3,
+                 (e.end - e.begin) / 1e3);
+        ++n_events;
+      });
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    spdlog::info("Wrote {} trace events to {}", n_events, filename);
+  }
+}
@@ -0,0 +1,74 @@
+#ifndef meld_utilities_tracer_hpp
+#define meld_utilities_tracer_hpp
+
+// =======================================================================================
+// The tracing facility records the beginning and end of framework activities--node
+// executions, message routing, filter decisions and flush emissions--so that they can be
+// inspected on a per-thread timeline.  An activity is recorded by creating a scope object
+// for its duration:
+//
+//   trace::scope const s{trace::category::node, name};
+//
+// where the name is an identifier obtained once (e.g. during node construction) from
+// trace::register_name.  Each thread records its events into its own fixed-size ring
+// buffer, which requires no synchronization with other threads; if a thread records more
+// events than the buffer can hold, its oldest events are overwritten.
+//
+// Recording is enabled at run time by calling trace::enable(), after which the recorded
+// events can be written in the Chrome trace-event format (viewable with Perfetto or
+// chrome://tracing) by calling trace::write_chrome_trace.
+//
+// Unless MELD_ENABLE_TRACING is defined at build time, a scope is an empty object and no
+// events are ever recorded.
+// =======================================================================================
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace meld::trace {
+  enum class category : std::uint8_t { node, multiplexer, filter, flush };
+  using name_t = std::uint32_t;
+
+  name_t register_name(std::string const& name);
+
+  void enable();
+  void write_chrome_trace(std::string const& filename);
+
+  namespace detail {
+    extern std::atomic<bool> enabled;
+    std::int64_t now() noexcept;
+    void record(category c, name_t name, std::int64_t begin, std::int64_t end) noexcept;
+  }
+
+#if defined(MELD_ENABLE_TRACING)
+  class scope {
+  public:
+    scope(category const c, name_t const name) noexcept :
+      begin_{detail::enabled.load(std::memory_order_relaxed) ? detail::now() : -1},
+      name_{name},
+      category_{c}
+    {
+    }
+
+    ~scope()
+    {
+      if (begin_ >= 0) {
+        detail::record(category_, name_, begin_, detail::now());
+      }
+    }
+
+  private:
+    std::int64_t begin_;
+    name_t name_;
+    category category_;
+  };
+#else
+  class scope {
+  public:
+    scope(category, name_t) noexcept {}
+  };
+#endif
+}
+
+#endif // meld_utilities_tracer_hpp
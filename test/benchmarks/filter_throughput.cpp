@@ -0,0 +1,101 @@
+// =======================================================================================
+// This benchmark measures the event throughput of a filtered node as a function of the
+// number of predicates it depends on and of the maximum parallelism of the framework.
+// Each predicate accepts every event, so that the filter forwards each message once all
+// of its predicate results have been received.  The predicate and monitor bodies are
+// trivial, thus the measured rate is dominated by the bookkeeping of the filter.
+//
+// Each measurement is repeated, and the fastest repetition is reported.  That every
+// event passes the filter is verified by the "Filter with many predicates" test (see
+// test/filter.cpp).
+// =======================================================================================
+
+#include "meld/core/framework_graph.hpp"
+#include "meld/model/product_store.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace meld;
+using namespace std::chrono;
+
+namespace {
+  class source {
+  public:
+    explicit source(std::size_t const max_n) : max_{max_n} {}
+
+    product_store_ptr next()
+    {
+      if (i_ == 0) {
+        ++i_;
+        return product_store::base();
+      }
+      if (i_ < max_ + 1) {
+        auto store = product_store::base()->make_child(i_, "event");
+        store->add_product<unsigned int>("num", i_ - 1);
+        ++i_;
+        return store;
+      }
+      return nullptr;
+    }
+
+  private:
+    std::size_t const max_;
+    std::size_t i_{};
+  };
+
+  double events_per_second(std::size_t const n_predicates,
+                           int const max_parallelism,
+                           std::size_t const n_events)
+  {
+    framework_graph g{[src = source{n_events}]() mutable { return src.next(); }, max_parallelism};
+
+    std::vector<std::string> predicate_names;
+    for (std::size_t i = 0; i != n_predicates; ++i) {
+      auto name = "accept_" + std::to_string(i);
+      g.with(name, [](unsigned int) { return true; }, concurrency::unlimited).evaluate("num");
+      predicate_names.push_back(std::move(name));
+    }
+
+    g.with("count", [](unsigned int) {}, concurrency::unlimited)
+      .when(predicate_names)
+      .monitor("num");
+
+    auto const start = steady_clock::now();
+    g.execute();
+    auto const elapsed = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+    return 1e9 * static_cast<double>(n_events) / elapsed;
+  }
+}
+
+int main()
+{
+  constexpr std::size_t n_events{20'000};
+  constexpr std::size_t n_repetitions{3};
+
+  // Suppress the framework's own reports so that only the table is printed.
+  spdlog::set_level(spdlog::level::warn);
+  events_per_second(1, 1, n_events); // Warm-up
+
+  std::vector<std::string> rows;
+  for (std::size_t const n_predicates : {1, 2, 4, 8}) {
+    for (int const max_parallelism : {1, 2, 4, 8, 16, 32, 64}) {
+      double best{};
+      for (std::size_t i = 0; i != n_repetitions; ++i) {
+        best = std::max(best, events_per_second(n_predicates, max_parallelism, n_events));
+      }
+      rows.push_back(fmt::format("{:>10}  {:>8}  {:>12.0f}", n_predicates, max_parallelism, best));
+    }
+  }
+
+  spdlog::set_level(spdlog::level::info);
+  spdlog::info("{:>10}  {:>8}  {:>12}", "Predicates", "Threads", "events/s");
+  for (auto const& row : rows) {
+    spdlog::info("{}", row);
+  }
+}
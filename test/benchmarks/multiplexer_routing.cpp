@@ -0,0 +1,82 @@
+// =======================================================================================
+// This microbenchmark measures the cost of routing a message through the multiplexer as
+// a function of the number of downstream nodes.  Each node has a single input port; half
+// of the nodes consume a product that is present in each event store, and the other half
+// consume a product that is never present, thus exercising both the accepting and the
+// rejecting paths of the router.  The downstream nodes are lightweight, so their bodies
+// execute on the calling thread and contribute negligible overhead.
+//
+// Each measurement is repeated, and the fastest repetition is reported, after a warm-up
+// run that absorbs one-time costs (e.g. starting the TBB worker threads).
+// =======================================================================================
+
+#include "meld/core/message.hpp"
+#include "meld/core/multiplexer.hpp"
+#include "meld/model/product_store.hpp"
+
+#include "oneapi/tbb/flow_graph.h"
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <vector>
+
+using namespace meld;
+using namespace std::chrono;
+
+namespace {
+  using sink_t = tbb::flow::function_node<message, tbb::flow::continue_msg, tbb::flow::lightweight>;
+
+  double ns_per_message(std::size_t const n_nodes, std::size_t const n_messages)
+  {
+    tbb::flow::graph g;
+    multiplexer multi{g};
+
+    std::deque<sink_t> sinks;
+    multiplexer::head_ports_t head_ports;
+    for (std::size_t i = 0; i != n_nodes; ++i) {
+      auto& sink = sinks.emplace_back(g, tbb::flow::unlimited, [](message const&) {
+        return tbb::flow::continue_msg{};
+      });
+      specified_label label{i % 2 == 0 ? "number" : "absent"};
+      head_ports["node_" + std::to_string(i)].push_back({std::move(label), &sink});
+    }
+    multi.finalize(std::move(head_ports));
+
+    auto run = product_store::base();
+    run->add_product("run_number", 1);
+    std::vector<product_store_ptr> events;
+    events.reserve(n_messages);
+    for (std::size_t i = 0; i != n_messages; ++i) {
+      auto event = run->make_child(i, "event");
+      event->add_product("number", static_cast<int>(i));
+      events.push_back(std::move(event));
+    }
+
+    auto const start = steady_clock::now();
+    for (std::size_t i = 0; i != n_messages; ++i) {
+      multi.multiplex({events[i], nullptr, i});
+    }
+    g.wait_for_all();
+    auto const elapsed = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+    return static_cast<double>(elapsed) / n_messages;
+  }
+}
+
+int main()
+{
+  constexpr std::size_t n_messages{20'000};
+  constexpr std::size_t n_repetitions{5};
+  ns_per_message(1, n_messages); // Warm-up
+  spdlog::info("{:>8}  {:>12}", "Nodes", "ns/message");
+  for (std::size_t const n_nodes : {1, 10, 50, 100, 200, 400}) {
+    double best{ns_per_message(n_nodes, n_messages)};
+    for (std::size_t i = 1; i != n_repetitions; ++i) {
+      best = std::min(best, ns_per_message(n_nodes, n_messages));
+    }
+    spdlog::info("{:>8}  {:>12.1f}", n_nodes, best);
+  }
+}
@@ -30,6 +30,7 @@
 #include "meld/core/framework_graph.hpp"
 #include "meld/model/level_id.hpp"
 #include "meld/model/product_store.hpp"
+#include "meld/utilities/execution_statistics.hpp"
 
 #include "catch2/catch_all.hpp"
 #include "spdlog/spdlog.h"
@@ -42,10 +43,17 @@ using namespace meld;
 
 namespace {
   void add(std::atomic<unsigned int>& counter, unsigned int number) { counter += number; }
+
+  struct statistics_enabled {
+    statistics_enabled() { enable_execution_statistics(); }
+    ~statistics_enabled() { enable_execution_statistics(false); }
+  };
 }
 
 TEST_CASE("Different hierarchies used with reduction", "[graph]")
 {
+  statistics_enabled const timing;
+
   // job -> run -> event levels
   constexpr auto index_limit = 2u;
   constexpr auto number_limit = 5u;
@@ -100,4 +108,10 @@ TEST_CASE("Different hierarchies used with reduction", "[graph]")
   CHECK(g.execution_counts("job_add") == index_limit * number_limit + primitive_limit);
   CHECK(g.execution_counts("verify_run_sum") == index_limit);
   CHECK(g.execution_counts("verify_job_sum") == 1);
+
+  auto const statistics = g.node_statistics();
+  CHECK(statistics.at("run_add").count == index_limit * number_limit);
+  CHECK(statistics.at("job_add").count == index_limit * number_limit + primitive_limit);
+  CHECK(statistics.at("verify_run_sum").count == index_limit);
+  CHECK(statistics.at("verify_job_sum").count == 1);
 }
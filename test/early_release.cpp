@@ -0,0 +1,138 @@
+// =======================================================================================
+// This test verifies that a product's payload is released as soon as all of the
+// product's consumers have finished with it, even though the store that contains the
+// product is still alive:
+//
+//    Multiplexer
+//      |     |
+//      |   count
+//      |     |
+//    first_value
+//         |
+//       check
+//
+// The "hits" product of each event is consumed by 'count' and 'first_value'.  By the
+// time 'check' is invoked for an event, both have finished with the event's hits, whose
+// payload must therefore have been released.
+// =======================================================================================
+
+#include "meld/core/cached_product_stores.hpp"
+#include "meld/core/framework_graph.hpp"
+#include "meld/model/level_id.hpp"
+#include "meld/model/product_store.hpp"
+
+#include "catch2/catch_all.hpp"
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+using namespace meld;
+
+namespace {
+  constexpr unsigned int total_events{10u};
+
+  // Each hits object records (by event number) whether its payload has been released.
+  std::array<std::atomic<bool>, total_events + 1> released{};
+
+  struct hits {
+    hits() = default;
+    hits(unsigned int const number) : event{number}, values(1000, number) {}
+    hits(hits const&) = default;
+    hits(hits&& other) noexcept : event{other.event}, values{std::move(other.values)}
+    {
+      other.event = 0u;
+    }
+    hits& operator=(hits&& other) noexcept
+    {
+      if (event != 0u) {
+        released[event] = true;
+      }
+      event = other.event;
+      values = std::move(other.values);
+      other.event = 0u;
+      return *this;
+    }
+    unsigned int event{};
+    std::vector<unsigned int> values;
+  };
+
+  auto make_source()
+  {
+    return [i = 0u](cached_product_stores& cached_stores) mutable -> product_store_ptr {
+      if (i > total_events) {
+        return nullptr;
+      }
+      auto const number = i++;
+      if (number == 0u) {
+        return cached_stores.get_store(level_id::base_ptr());
+      }
+      auto store = cached_stores.get_store(level_id::base().make_child(number, "event"));
+      store->add_product("hits", hits{number});
+      store->add_product("number", number);
+      return store;
+    };
+  }
+
+  std::size_t count(hits const& h) { return size(h.values); }
+
+  unsigned int first_value(hits const& h, std::size_t const count)
+  {
+    return count == 0u ? 0u : h.values.front();
+  }
+
+  void reset_flags()
+  {
+    for (auto& flag : released) {
+      flag = false;
+    }
+  }
+}
+
+TEST_CASE("Product released after its last consumer", "[graph]")
+{
+  reset_flags();
+
+  std::atomic<unsigned int> not_released{};
+  framework_graph g{make_source()};
+  g.with(count, concurrency::unlimited).transform("hits").to("count");
+  g.with(first_value, concurrency::unlimited).transform("hits", "count").to("first");
+  g.with(
+     "check",
+     [&not_released](unsigned int const number) {
+       if (not released[number]) {
+         ++not_released;
+       }
+     },
+     concurrency::unlimited)
+    .monitor("first");
+  g.execute();
+
+  CHECK(g.execution_counts("check") == total_events);
+  CHECK(not_released == 0u);
+}
+
+TEST_CASE("Product retained while a consumer has not run", "[graph]")
+{
+  reset_flags();
+
+  std::atomic<unsigned int> released_early{};
+  framework_graph g{make_source()};
+  g.with(count, concurrency::unlimited).transform("hits").to("count");
+  g.with(
+     "check",
+     [&released_early](std::size_t, unsigned int const number) {
+       if (released[number]) {
+         ++released_early;
+       }
+     },
+     concurrency::unlimited)
+    .monitor("count", "number");
+  // Consumes the hits product, but its other input product is never created
+  g.with("never", [](hits const&, int) {}, concurrency::unlimited).monitor("hits", "missing");
+  g.execute();
+
+  CHECK(g.execution_counts("check") == total_events);
+  CHECK(g.execution_counts("never") == 0u);
+  CHECK(released_early == 0u);
+}
@@ -4,6 +4,10 @@
 #include "catch2/catch_all.hpp"
 #include "oneapi/tbb/concurrent_vector.h"
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 using namespace meld;
 using namespace oneapi::tbb;
 
@@ -177,3 +181,102 @@ TEST_CASE("Two predicates in parallel (each with multiple arguments)", "[filteri
 
   g.execute("two_predicates_in_parallel_multiarg_t");
 }
+
+TEST_CASE("On-demand predicates", "[filtering]")
+{
+  constexpr unsigned int n_events{100u};
+  // With a single thread, each message is resolved once the previous ones have been, so
+  // that the costs measured for the predicates are up to date.
+  framework_graph g{[src = source{n_events}]() mutable { return src.next(); }, 1};
+  g.with(evens_only, concurrency::unlimited).evaluate("num").on_demand();
+  g.with(
+     "slow_accept_all",
+     [](unsigned int) {
+       std::this_thread::sleep_for(std::chrono::microseconds{100});
+       return true;
+     },
+     concurrency::unlimited)
+    .evaluate("num")
+    .on_demand();
+  g.make<sum_numbers>(2450u)
+    .with(&sum_numbers::add, concurrency::unlimited)
+    .when("slow_accept_all", "evens_only")
+    .monitor("num");
+
+  g.execute("on_demand_predicates_t");
+
+  CHECK(g.execution_counts("evens_only") == n_events);
+  // The slow predicate is evaluated for at most one event before its cost has been
+  // measured.  It is then evaluated only for the events that have not been rejected by
+  // the other predicate.
+  CHECK(g.execution_counts("slow_accept_all") <= n_events / 2 + 1);
+}
+
+TEST_CASE("On-demand predicate shared by several consumers", "[filtering]")
+{
+  framework_graph g{[src = source{10u}]() mutable { return src.next(); }};
+  g.with(evens_only, concurrency::unlimited).evaluate("num").on_demand();
+  g.with(odds_only, concurrency::unlimited).evaluate("num");
+  g.make<collect_numbers>(std::initializer_list<unsigned int>{})
+    .with("collect_none", &collect_numbers::collect, concurrency::unlimited)
+    .when("odds_only", "evens_only")
+    .monitor("num");
+  auto const expected_numbers = {0u, 2u, 4u, 6u, 8u};
+  g.make<collect_numbers>(expected_numbers)
+    .with("collect_evens", &collect_numbers::collect, concurrency::unlimited)
+    .when("evens_only")
+    .monitor("num");
+
+  g.execute("on_demand_predicate_shared_t");
+
+  // The on-demand predicate is evaluated at most once per event.
+  CHECK(g.execution_counts("evens_only") == 10u);
+}
+
+TEST_CASE("On-demand predicate with limited concurrency", "[filtering]")
+{
+  constexpr unsigned int n_events{40u};
+  std::atomic<unsigned int> active{};
+  std::atomic<unsigned int> max_active{};
+  auto accept_all = [&active, &max_active](unsigned int) {
+    auto const now_active = ++active;
+    auto observed = max_active.load();
+    while (observed < now_active and not max_active.compare_exchange_weak(observed, now_active)) {}
+    std::this_thread::sleep_for(std::chrono::microseconds{200});
+    --active;
+    return true;
+  };
+
+  framework_graph g{[src = source{n_events}]() mutable { return src.next(); }};
+  g.with("accept_all", accept_all, concurrency{2}).evaluate("num").on_demand();
+  g.make<sum_numbers>(780u)
+    .with(&sum_numbers::add, concurrency::unlimited)
+    .when("accept_all")
+    .monitor("num");
+
+  g.execute("on_demand_limited_concurrency_t");
+
+  CHECK(g.execution_counts("accept_all") == n_events);
+  CHECK(max_active <= 2u);
+}
+
+TEST_CASE("Filter with many predicates", "[filtering]")
+{
+  constexpr unsigned int n_events{2'000u};
+  std::vector<std::string> predicate_names;
+  auto const max_parallelism = GENERATE(1, 4, 16);
+  framework_graph g{[src = source{n_events}]() mutable { return src.next(); }, max_parallelism};
+  for (std::size_t i = 0; i != 8; ++i) {
+    auto name = "accept_" + std::to_string(i);
+    g.with(name, [](unsigned int) { return true; }, concurrency::unlimited).evaluate("num");
+    predicate_names.push_back(std::move(name));
+  }
+  std::atomic<unsigned int> seen{};
+  g.with("count", [&seen](unsigned int) { ++seen; }, concurrency::unlimited)
+    .when(predicate_names)
+    .monitor("num");
+
+  g.execute("filter_with_many_predicates_t");
+
+  CHECK(seen == n_events);
+}
@@ -1,36 +1,84 @@
 #include "meld/core/detail/filter_impl.hpp"
 
 #include "catch2/catch_all.hpp"
+#include "oneapi/tbb/parallel_for.h"
 
-using namespace meld;
+#include <atomic>
+#include <vector>
 
-TEST_CASE("Filter values", "[filtering]")
-{
-  CHECK(is_complete(true_value));
-  CHECK(is_complete(false_value));
-  CHECK(not is_complete(0u));
-}
+using namespace meld;
 
 TEST_CASE("Filter decision", "[filtering]")
 {
-  decision_map decisions{2};
-  decisions.update({nullptr, 1, false});
+  filter_state state{2, filter_state::for_output};
+  auto const store = product_store::base();
+  CHECK(state.update({nullptr, 1, false}) == nullptr);
+  CHECK(state.update(message{store, nullptr, 1}) == nullptr);
   {
-    auto const value = decisions.value(1);
-    CHECK(is_complete(value));
-    CHECK(to_boolean(value) == false);
-    decisions.erase(1);
+    auto const slot = state.update({nullptr, 1, true});
+    REQUIRE(slot);
+    CHECK(not slot->accepted());
   }
-  decisions.update({nullptr, 3, true});
-  {
-    auto const value = decisions.value(3);
-    CHECK(not is_complete(value));
-  }
-  decisions.update({nullptr, 3, true});
+
+  CHECK(state.update({nullptr, 3, true}) == nullptr);
+  CHECK(state.update({nullptr, 3, true}) == nullptr);
   {
-    auto const value = decisions.value(3);
-    CHECK(is_complete(value));
-    CHECK(to_boolean(value) == true);
-    decisions.erase(3);
+    auto const slot = state.update(message{store, nullptr, 3});
+    REQUIRE(slot);
+    CHECK(slot->accepted());
+    CHECK(slot->messages()[0].store == store);
   }
+  CHECK(state.size() == 0ull);
+}
+
+TEST_CASE("Filter data for multiple arguments", "[filtering]")
+{
+  std::vector<specified_label> const labels{{"a"}, {"b"}};
+  filter_state state{1, labels};
+
+  auto const event = product_store::base()->make_child(1, "event");
+  event->add_product("b", 2);
+  auto const continuation = event->make_continuation("make_a");
+  continuation->add_product("a", 1);
+
+  CHECK(state.update(message{event, nullptr, 7}) == nullptr);
+  CHECK(state.update(message{continuation, nullptr, 7}) == nullptr);
+  auto const slot = state.update({nullptr, 7, true});
+  REQUIRE(slot);
+  CHECK(slot->accepted());
+  // The messages are ordered according to the input arguments.
+  CHECK(slot->messages()[0].store == continuation);
+  CHECK(slot->messages()[1].store == event);
+}
+
+TEST_CASE("Concurrent filter updates", "[filtering]")
+{
+  constexpr std::size_t n_messages{100'000};
+  constexpr unsigned int n_predicates{4};
+  filter_state state{n_predicates, filter_state::for_output};
+  auto const store = product_store::base();
+
+  std::atomic<std::size_t> completed{};
+  std::atomic<std::size_t> accepted{};
+  auto count = [&](std::unique_ptr<filter_slot> const& slot) {
+    if (slot) {
+      ++completed;
+      accepted += slot->accepted();
+    }
+  };
+
+  // Each message ID receives one data message and one result from each predicate.
+  tbb::parallel_for(std::size_t{}, n_messages * (n_predicates + 1), [&](std::size_t const i) {
+    auto const msg_id = i / (n_predicates + 1);
+    if (auto const k = i % (n_predicates + 1); k == n_predicates) {
+      count(state.update(message{store, nullptr, msg_id}));
+    }
+    else {
+      count(state.update({nullptr, msg_id, k != 0 or msg_id % 2 == 0}));
+    }
+  });
+
+  CHECK(completed == n_messages);
+  CHECK(accepted == n_messages / 2);
+  CHECK(state.size() == 0ull);
 }
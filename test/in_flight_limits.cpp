@@ -0,0 +1,137 @@
+// =======================================================================================
+// This test verifies that the number of stores concurrently live in the graph is bounded
+// by the user-specified limits.  The hierarchy tested is:
+//
+//    job
+//     │
+//     └ run
+//        │
+//        └ event
+//
+// Each event is processed by a deliberately slow monitor.  Whenever the source reads a
+// new event, the previously read event must have been admitted, which is possible only
+// if no more than the maximum number of events were live at that time.
+// =======================================================================================
+
+#include "meld/core/cached_product_stores.hpp"
+#include "meld/core/framework_graph.hpp"
+#include "meld/model/level_id.hpp"
+#include "meld/model/product_store.hpp"
+
+#include "catch2/catch_all.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace meld;
+using namespace std::chrono_literals;
+
+namespace {
+  constexpr auto run_limit = 3u;
+  constexpr auto event_limit = 40u;
+
+  std::vector<level_id_ptr> make_levels()
+  {
+    std::vector<level_id_ptr> levels;
+    auto job_id = levels.emplace_back(level_id::base_ptr());
+    for (unsigned i = 0u; i != run_limit; ++i) {
+      auto run_id = levels.emplace_back(job_id->make_child(i, "run"));
+      for (unsigned j = 0u; j != event_limit; ++j) {
+        levels.push_back(run_id->make_child(j, "event"));
+      }
+    }
+    return levels;
+  }
+
+  void add(std::atomic<unsigned int>& counter, unsigned int number) { counter += number; }
+}
+
+TEST_CASE("Limit the number of in-flight events", "[graph]")
+{
+  constexpr std::size_t max_events_in_flight{4};
+  std::atomic<unsigned> events_read{};
+  std::atomic<unsigned> events_processed{};
+  std::atomic<unsigned> max_difference{};
+
+  auto const levels = make_levels();
+  auto it = cbegin(levels);
+  auto const e = cend(levels);
+  framework_graph g{
+    [&, it, e](cached_product_stores& cached_stores) mutable -> product_store_ptr {
+      if (it == e) {
+        return nullptr;
+      }
+      auto const& id = *it++;
+      auto store = cached_stores.get_store(id);
+      if (id->level_name() == "event") {
+        auto const difference = ++events_read - events_processed;
+        if (difference > max_difference) {
+          max_difference = difference;
+        }
+        store->add_product<unsigned>("number", id->number());
+      }
+      return store;
+    },
+    oneapi::tbb::info::default_concurrency(),
+    {{"event", max_events_in_flight}}};
+
+  g.with(
+     "slow",
+     [&events_processed](unsigned int) {
+       std::this_thread::sleep_for(1ms);
+       ++events_processed;
+     },
+     concurrency::unlimited)
+    .monitor("number");
+  g.with("run_add", add, concurrency::unlimited)
+    .reduce("number")
+    .for_each("run")
+    .to("run_sum")
+    .initialized_with(0u);
+  g.with("verify_run_sum", [](unsigned int actual) { CHECK(actual == 780u); }).monitor("run_sum");
+
+  g.execute();
+
+  CHECK(g.execution_counts("slow") == run_limit * event_limit);
+  CHECK(g.execution_counts("verify_run_sum") == run_limit);
+  CHECK(max_difference <= max_events_in_flight + 1);
+}
+
+TEST_CASE("Limit the number of in-flight runs", "[graph]")
+{
+  auto const levels = make_levels();
+  auto it = cbegin(levels);
+  auto const e = cend(levels);
+  framework_graph g{[it, e](cached_product_stores& cached_stores) mutable -> product_store_ptr {
+                      if (it == e) {
+                        return nullptr;
+                      }
+                      auto const& id = *it++;
+                      auto store = cached_stores.get_store(id);
+                      if (id->level_name() == "event") {
+                        store->add_product<unsigned>("number", id->number());
+                      }
+                      return store;
+                    },
+                    oneapi::tbb::info::default_concurrency(),
+                    {{"run", 1}, {"event", 2}}};
+
+  g.with("run_add", add, concurrency::unlimited)
+    .reduce("number")
+    .for_each("run")
+    .to("run_sum")
+    .initialized_with(0u);
+  g.with("verify_run_sum", [](unsigned int actual) { CHECK(actual == 780u); }).monitor("run_sum");
+
+  g.execute();
+
+  CHECK(g.execution_counts("run_add") == run_limit * event_limit);
+  CHECK(g.execution_counts("verify_run_sum") == run_limit);
+}
+
+TEST_CASE("In-flight limits must be positive", "[graph]")
+{
+  CHECK_THROWS(framework_graph{product_store::base(), 1, {{"event", 0}}});
+}
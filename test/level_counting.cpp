@@ -96,3 +96,33 @@ TEST_CASE("Counter multiple layers deep", "[data model]")
   CHECK(results.count_for(run_hash_value) == nruns);
   check_all_processed();
 }
+
+TEST_CASE("Counter with declared child counts", "[data model]")
+{
+  constexpr std::size_t nruns{2ull};
+  constexpr std::size_t nevents_per_run{5ull};
+
+  auto const run_hash_value = hash(job_hash_value, "run");
+  auto const event_hash_value = hash(run_hash_value, "event");
+
+  flush_counters counters;
+  auto job_store = product_store::base();
+  counters.update(job_store->id());
+  for (std::size_t i = 0; i != nruns; ++i) {
+    auto run_store = job_store->make_child(i, "run");
+    // The source declares one more event than it emits, which shows that the declared
+    // count is reported instead of the counted one.
+    run_store->declare_child_counts({{"event", nevents_per_run + 1}});
+    counters.update(run_store->id(), run_store->declared_child_counts());
+    for (std::size_t k = 0; k != nevents_per_run; ++k) {
+      auto event_store = run_store->make_child(k, "event");
+      counters.update(event_store->id());
+      CHECK(counters.extract(event_store->id()).empty());
+    }
+    auto results = counters.extract(run_store->id());
+    CHECK(results.count_for(event_hash_value) == nevents_per_run + 1);
+  }
+  auto results = counters.extract(job_store->id());
+  CHECK(results.count_for(run_hash_value) == nruns);
+  CHECK(results.count_for(event_hash_value) == nruns * (nevents_per_run + 1));
+}
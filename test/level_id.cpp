@@ -2,6 +2,11 @@
 
 #include "catch2/catch_all.hpp"
 
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
 using namespace meld;
 
 TEST_CASE("Level ID string literal", "[data model]")
@@ -32,3 +37,63 @@ TEST_CASE("Verify independent hashes", "[data model]")
   CHECK(event_760->hash() != event_4999->hash());
   CHECK(event_760->level_hash() == event_4999->level_hash());
 }
+
+TEST_CASE("Level names are shared", "[data model]")
+{
+  auto run = level_id::base().make_child(0, "run");
+  auto event_1 = run->make_child(1, "event");
+  auto event_2 = run->make_child(2, "event");
+  CHECK(&event_1->level_name() == &event_2->level_name());
+  CHECK(event_1->level_hash() == event_2->level_hash());
+
+  // The same level name in a different hierarchy is a different level
+  auto other_event = level_id::base().make_child(1, "event");
+  CHECK(other_event->level_name() == event_1->level_name());
+  CHECK(other_event->level_hash() != event_1->level_hash());
+  CHECK(*event_1->parent("run") == *run);
+}
+
+TEST_CASE("Level names are interned concurrently", "[data model]")
+{
+  auto run = level_id::base().make_child(0, "concurrent_run");
+  std::vector<std::string> const names{"a", "b", "c", "d"};
+  std::vector<std::vector<level_id_ptr>> children(8);
+  {
+    std::vector<std::jthread> threads;
+    for (auto& ids : children) {
+      threads.emplace_back([&run, &names, &ids] {
+        for (std::size_t i = 0; i != 100; ++i) {
+          ids.push_back(run->make_child(i, names[i % names.size()]));
+        }
+      });
+    }
+  }
+
+  for (auto const& ids : children) {
+    for (std::size_t i = 0; i != ids.size(); ++i) {
+      auto const& expected = children[0][i];
+      CHECK(&ids[i]->level_name() == &expected->level_name());
+      CHECK(ids[i]->level_hash() == expected->level_hash());
+    }
+  }
+  // Each name is a different level
+  CHECK(children[0][0]->level_hash() != children[0][1]->level_hash());
+  CHECK(children[0][1]->level_name() == "b");
+}
+
+TEST_CASE("Compare level IDs", "[data model]")
+{
+  CHECK(*"1:2"_id == *"1:2"_id);
+  CHECK_FALSE(*"1:2"_id == *"1:3"_id);
+  CHECK_FALSE(*"1:2"_id == *"1:2:0"_id);
+  CHECK_FALSE(*"1:2"_id == *"2:2"_id);
+
+  CHECK(*""_id < *"0"_id);
+  CHECK(*"1:2"_id < *"1:3"_id);
+  CHECK(*"1:2"_id < *"1:2:0"_id);
+  CHECK(*"1:2:7"_id < *"1:3"_id);
+  CHECK(*"1:2:7"_id < *"2"_id);
+  CHECK_FALSE(*"1:3"_id < *"1:2:7"_id);
+  CHECK_FALSE(*"1:2"_id < *"1:2"_id);
+  CHECK_FALSE(*"1:2:0"_id < *"1:2"_id);
+}
@@ -0,0 +1,45 @@
+#include "meld/core/framework_graph.hpp"
+#include "meld/model/product_store.hpp"
+
+#include <atomic>
+
+using namespace meld;
+
+namespace {
+  void add(std::atomic<unsigned int>& counter, unsigned int number) { counter += number; }
+}
+
+int main()
+{
+  // Each subrun contains one event and is its own reduction interval.
+  constexpr auto max_subruns{100'000u};
+  // constexpr auto max_subruns{1'000'000u};
+
+  framework_graph g{[i = 0u, run = product_store_ptr{}, subrun = product_store_ptr{}]() mutable
+                    -> product_store_ptr {
+    if (i == 2 * max_subruns + 2) { // + 2 is for the job and run stores
+      return nullptr;
+    }
+    auto const n = i++;
+    if (n == 0u) {
+      return product_store::base();
+    }
+    if (n == 1u) {
+      return run = product_store::base()->make_child(0, "run", "Source");
+    }
+
+    auto const subrun_number = (n - 2) / 2;
+    if (n % 2 == 0u) {
+      return subrun = run->make_child(subrun_number, "subrun", "Source");
+    }
+    auto store = subrun->make_child(0, "event", "Source");
+    store->add_product("number", subrun_number);
+    return store;
+  }};
+
+  g.with("subrun_add", add, concurrency::unlimited)
+    .reduce("number")
+    .for_each("subrun")
+    .to("subrun_sum");
+  g.execute();
+}
@@ -0,0 +1,124 @@
+#include "meld/core/multiplexer.hpp"
+#include "meld/core/products_consumer.hpp"
+#include "meld/model/product_store.hpp"
+
+#include "catch2/catch_all.hpp"
+#include "oneapi/tbb/flow_graph.h"
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace meld;
+
+namespace {
+  // Records the level names of the data and flush messages it receives
+  class recording_node : public products_consumer {
+  public:
+    recording_node(tbb::flow::graph& g,
+                   std::string name,
+                   std::string product_name,
+                   std::vector<std::string> flush_levels = {}) :
+      products_consumer{std::move(name), {}, {}},
+      input_{specified_label::create(std::move(product_name))},
+      flush_levels_{std::move(flush_levels)},
+      port_{g, tbb::flow::unlimited, [this](message const& msg) {
+              record(msg);
+              return tbb::flow::continue_msg{};
+            }}
+    {
+    }
+
+    std::vector<std::string> data() const { return sorted(data_); }
+    std::vector<std::string> flushes() const { return sorted(flushes_); }
+    specified_labels input() const override { return input_; }
+
+  private:
+    void record(message const& msg)
+    {
+      std::lock_guard lock{mutex_};
+      auto& levels = msg.store->is_flush() ? flushes_ : data_;
+      levels.push_back(msg.store->level_name());
+    }
+
+    std::vector<std::string> sorted(std::vector<std::string> const& levels) const
+    {
+      std::lock_guard lock{mutex_};
+      auto result = levels;
+      std::ranges::sort(result);
+      return result;
+    }
+
+    tbb::flow::receiver<message>& port_for(specified_label const&) override { return port_; }
+    std::vector<tbb::flow::receiver<message>*> ports() override { return {&port_}; }
+    void try_put_all(message const& msg, std::span<std::size_t const> depths) override
+    {
+      record(ancestor_message(msg, depths[0]));
+    }
+    std::vector<std::string> flush_levels() const override { return flush_levels_; }
+    void set_consumer_count(specified_label const&, std::size_t) override {}
+    std::size_t num_calls() const override { return 0ull; }
+
+    std::vector<specified_label> input_;
+    std::vector<std::string> flush_levels_;
+    tbb::flow::function_node<message> port_;
+    mutable std::mutex mutex_;
+    std::vector<std::string> data_;
+    std::vector<std::string> flushes_;
+  };
+}
+
+TEST_CASE("Flush messages are sent only to the nodes that require them", "[multiplexing]")
+{
+  tbb::flow::graph g;
+  recording_node run_node{g, "run_node", "r"};
+  recording_node event_node{g, "event_node", "e"};
+  recording_node reduction_node{g, "reduction_node", "e", {"run"}};
+  recording_node untargeted_node{g, "untargeted_node", "e"};
+
+  multiplexer multi{g};
+  multiplexer::head_ports_t head_ports;
+  multiplexer::nodes_t targeted;
+  for (auto* node : {&run_node, &event_node, &reduction_node, &untargeted_node}) {
+    auto const& label = node->input()[0];
+    head_ports[node->full_name()].push_back({label, &node->port(label)});
+    if (node != &untargeted_node) {
+      targeted.try_emplace(node->full_name(), node);
+    }
+  }
+  multi.finalize(std::move(head_ports), {}, targeted);
+
+  auto const job = product_store::base();
+  auto const run = job->make_child(1, "run");
+  run->add_product("r", 1);
+  auto const event1 = run->make_child(1, "event");
+  event1->add_product("e", 1);
+  auto const event2 = run->make_child(2, "event");
+  event2->add_product("e", 2);
+
+  multi.try_put({job, nullptr, 1});
+  multi.try_put({run, nullptr, 2});
+  multi.try_put({event1, nullptr, 3});
+  multi.try_put({event1->make_flush(), nullptr, 4, 3});
+  // The flush message of the second event is received before its data message.
+  multi.try_put({event2->make_flush(), nullptr, 5, 6});
+  multi.try_put({event2, nullptr, 6});
+  multi.try_put({run->make_flush(), nullptr, 7, 2});
+  multi.try_put({job->make_flush(), nullptr, 8, 1});
+  g.wait_for_all();
+
+  using levels = std::vector<std::string>;
+  // Each event message also delivers the run store to the run node.
+  CHECK(run_node.data() == levels{"run", "run", "run"});
+  CHECK(run_node.flushes() == levels{"run"});
+
+  CHECK(event_node.data() == levels{"event", "event"});
+  CHECK(event_node.flushes() == levels{"event", "event"});
+
+  CHECK(reduction_node.data() == levels{"event", "event"});
+  CHECK(reduction_node.flushes() == levels{"event", "event", "run"});
+
+  CHECK(untargeted_node.data() == levels{"event", "event"});
+  CHECK(untargeted_node.flushes() == levels{"event", "event", "job", "run"});
+}
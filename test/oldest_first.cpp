@@ -0,0 +1,99 @@
+// =======================================================================================
+// This test verifies how messages waiting for a node with limited concurrency are handed
+// to the node's body.  By default, they are processed in the order in which they arrived.
+// With oldest-first scheduling enabled, they are processed in the order of their message
+// IDs.  The first message occupies the serial node until all other messages have been
+// submitted, which is done concurrently from several threads.
+// =======================================================================================
+
+#include "meld/concurrency.hpp"
+#include "meld/core/message.hpp"
+#include "meld/model/product_store.hpp"
+
+#include "catch2/catch_all.hpp"
+#include "oneapi/tbb/flow_graph.h"
+#include "oneapi/tbb/parallel_for_each.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+using namespace meld;
+
+namespace {
+  class serial_node {
+  public:
+    serial_node() :
+      body_{g_,
+            concurrency::serial.value,
+            [this](messages_t<1> const& messages) {
+              while (not all_submitted_) {
+                std::this_thread::yield();
+              }
+              processed_.push_back(std::get<0>(messages).id);
+              return tbb::flow::continue_msg{};
+            }},
+      edge_{g_, concurrency::serial.value, join_, body_}
+    {
+    }
+
+    ~serial_node() { g_.wait_for_all(); }
+
+    std::vector<std::size_t> process(std::vector<std::size_t> const& ids, bool concurrently)
+    {
+      // The messages are submitted directly to the edge, as a multiplexer does.
+      auto store = product_store::base();
+      auto submit = [this, &store](std::size_t const id) {
+        edge_.try_put_all({store, nullptr, id}, no_ancestors);
+      };
+      if (concurrently) {
+        tbb::parallel_for_each(ids, submit);
+      }
+      else {
+        std::ranges::for_each(ids, submit);
+      }
+      all_submitted_ = true;
+      g_.wait_for_all();
+      return processed_;
+    }
+
+  private:
+    tbb::flow::graph g_;
+    join_or_none_t<1> join_{g_, MessageHasher{}};
+    tbb::flow::function_node<messages_t<1>, tbb::flow::continue_msg, tbb::flow::rejecting> body_;
+    ordered_edge<1> edge_;
+    std::atomic<bool> all_submitted_{false};
+    std::vector<std::size_t> processed_;
+    static constexpr std::array<std::size_t, 1> no_ancestors{};
+  };
+
+  struct oldest_first_scheduling {
+    oldest_first_scheduling() { enable_oldest_first(); }
+    ~oldest_first_scheduling() { enable_oldest_first(false); }
+  };
+
+  std::vector<std::size_t> const ids{7, 1, 12, 5, 3, 9, 4, 11, 2, 8, 10, 6};
+}
+
+TEST_CASE("Waiting messages are processed in arrival order by default", "[graph]")
+{
+  REQUIRE_FALSE(oldest_first_enabled());
+  serial_node node;
+  CHECK(node.process(ids, false) == ids);
+}
+
+TEST_CASE("Waiting messages are processed oldest first", "[graph]")
+{
+  oldest_first_scheduling const enabled;
+  serial_node node;
+  auto const processed = node.process(ids, true);
+  REQUIRE(size(processed) == size(ids));
+
+  // Whichever message arrives first occupies the node while the others are submitted;
+  // all of the messages that have waited are then processed oldest first.
+  CHECK(std::ranges::is_sorted(processed.begin() + 1, processed.end()));
+  CHECK(std::ranges::is_permutation(processed, ids));
+}
@@ -0,0 +1,115 @@
+// =======================================================================================
+// This test verifies that a product is handed over (moved) to an algorithm that takes
+// it as owned<T>, but only if the algorithm is the product's sole consumer and no
+// output nodes are registered.  Otherwise, the algorithm receives a copy of the product.
+// =======================================================================================
+
+#include "meld/core/cached_product_stores.hpp"
+#include "meld/core/framework_graph.hpp"
+#include "meld/model/level_id.hpp"
+#include "meld/model/owned.hpp"
+#include "meld/model/product_store.hpp"
+
+#include "catch2/catch_all.hpp"
+
+#include <atomic>
+#include <vector>
+
+using namespace meld;
+
+namespace {
+  constexpr unsigned int total_events{10u};
+
+  std::atomic<unsigned int> copies{};
+
+  struct hits {
+    hits() = default;
+    hits(hits const& other) : values{other.values} { ++copies; }
+    hits(hits&&) = default;
+    hits& operator=(hits const&) = delete;
+    hits& operator=(hits&&) = default;
+    std::vector<unsigned int> values;
+  };
+
+  auto make_source()
+  {
+    return [i = 0u](cached_product_stores& cached_stores) mutable -> product_store_ptr {
+      if (i > total_events) {
+        return nullptr;
+      }
+      auto const number = i++;
+      if (number == 0u) {
+        return cached_stores.get_store(level_id::base_ptr());
+      }
+      auto store = cached_stores.get_store(level_id::base().make_child(number, "event"));
+      hits h;
+      h.values.assign(1000, number);
+      store->add_product("hits", std::move(h));
+      return store;
+    };
+  }
+
+  hits calibrate(owned<hits> h)
+  {
+    for (auto& value : h->values) {
+      value *= 2;
+    }
+    return std::move(h).release();
+  }
+
+  struct sum_of_hits {
+    std::atomic<unsigned int>& sum;
+    void add(hits const& h) { sum += h.values.front(); }
+  };
+
+  struct output_sink {
+    void save(product_store const&) const {}
+  };
+}
+
+TEST_CASE("Product handed over to its sole consumer", "[graph]")
+{
+  copies = 0;
+  std::atomic<unsigned int> sum{};
+  framework_graph g{make_source()};
+  g.with(calibrate, concurrency::unlimited).transform("hits").to("calibrated_hits");
+  g.make<sum_of_hits>(sum)
+    .with(&sum_of_hits::add, concurrency::unlimited)
+    .monitor("calibrated_hits");
+  g.execute();
+
+  CHECK(g.execution_counts("calibrate") == total_events);
+  CHECK(sum == total_events * (total_events + 1));
+  CHECK(copies == 0u);
+}
+
+TEST_CASE("Product copied for one of several consumers", "[graph]")
+{
+  copies = 0;
+  std::atomic<unsigned int> sum{};
+  std::atomic<unsigned int> calibrated_sum{};
+  framework_graph g{make_source()};
+  g.with(calibrate, concurrency::unlimited).transform("hits").to("calibrated_hits");
+  g.make<sum_of_hits>(sum)
+    .with("add_raw", &sum_of_hits::add, concurrency::unlimited)
+    .monitor("hits");
+  g.make<sum_of_hits>(calibrated_sum)
+    .with("add_calibrated", &sum_of_hits::add, concurrency::unlimited)
+    .monitor("calibrated_hits");
+  g.execute();
+
+  CHECK(sum == total_events * (total_events + 1) / 2);
+  CHECK(calibrated_sum == total_events * (total_events + 1));
+  CHECK(copies == total_events);
+}
+
+TEST_CASE("Product copied when outputs are registered", "[graph]")
+{
+  copies = 0;
+  framework_graph g{make_source()};
+  g.with(calibrate, concurrency::unlimited).transform("hits").to("calibrated_hits");
+  g.make<output_sink>().output_with(&output_sink::save, concurrency::unlimited);
+  g.execute();
+
+  CHECK(copies == total_events);
+}
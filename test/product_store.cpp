@@ -3,11 +3,22 @@
 
 #include "catch2/catch_all.hpp"
 
+#include <memory>
+#include <string>
 #include <tuple>
 #include <vector>
 
 using namespace meld;
 
+namespace {
+  struct copy_counter {
+    explicit copy_counter(int& copies) : copies{&copies} {}
+    copy_counter(copy_counter const& other) : copies{other.copies} { ++*copies; }
+    copy_counter(copy_counter&&) = default;
+    int* copies;
+  };
+}
+
 TEST_CASE("Product store insertion", "[data model]")
 {
   auto store = product_store::base();
@@ -36,6 +47,55 @@ TEST_CASE("Product store insertion", "[data model]")
   CHECK(store->get_product<std::vector<int>>("numbers") == many_numbers);
 }
 
+TEST_CASE("Product lookup by interned name", "[data model]")
+{
+  product_id const number_id{"number"};
+  CHECK(number_id == product_id{"number"});
+  CHECK(number_id != product_id{"numbers"});
+  CHECK(number_id.name() == "number");
+
+  auto store = product_store::base();
+  store->add_product("number", 4);
+  CHECK(store->contains_product(number_id));
+  CHECK(*store->get_handle<int>(number_id) == 4);
+
+  auto invalid_handle = store->get_handle<int>(product_id{"wrong_key"});
+  CHECK_THROWS_WITH(*invalid_handle,
+                    Catch::Matchers::ContainsSubstring(
+                      "No product exists with the name 'wrong_key'."));
+
+  std::vector<std::string> names;
+  for (auto const& [id, _] : *store) {
+    names.push_back(id.name());
+  }
+  CHECK(names == std::vector<std::string>{"number"});
+}
+
+TEST_CASE("Moving and emplacing products", "[data model]")
+{
+  int copies{};
+  copy_counter counter{copies};
+
+  auto store = product_store::base();
+  store->add_product("moved", std::move(counter));
+  store->emplace_product<copy_counter>("emplaced", copies);
+  store->emplace_product<std::vector<int>>("numbers", 3, 7);
+
+  products new_products;
+  new_products.add_all(to_product_ids(std::array<qualified_name, 2>{"a", "b"}),
+                       std::tuple{copy_counter{copies}, copy_counter{copies}});
+  auto child = store->make_continuation("source", std::move(new_products));
+  CHECK(child->contains_product("a"));
+  CHECK(copies == 0);
+
+  // Move-only products
+  store->add_product("pointer", std::make_unique<int>(4));
+  store->emplace_product<std::unique_ptr<int>>("emplaced_pointer", new int{5});
+  CHECK(*store->get_product<std::unique_ptr<int>>("pointer") == 4);
+  CHECK(*store->get_product<std::unique_ptr<int>>("emplaced_pointer") == 5);
+  CHECK(store->get_product<std::vector<int>>("numbers") == std::vector{7, 7, 7});
+}
+
 TEST_CASE("Product store derivation", "[data model]")
 {
   SECTION("Only one store")
@@ -72,3 +132,36 @@ TEST_CASE("Product store derivation", "[data model]")
   CHECK(leaf == most_derived(order_b));
   CHECK(leaf == most_derived(order_c));
 }
+
+TEST_CASE("Product store layouts", "[data model]")
+{
+  auto run_a = product_store::base()->make_child(1, "run");
+  auto run_b = product_store::base()->make_child(2, "run");
+  run_a->add_product("calibration", 1);
+  run_b->add_product("calibration", 2);
+
+  auto event_a = run_a->make_child(1, "event");
+  event_a->add_product("number", 1);
+  event_a->add_product("energy", 1.5);
+  auto event_b = run_b->make_child(1, "event");
+  event_b->add_product("energy", 2.5);
+  event_b->add_product("number", 2);
+
+  // Same products (in any order) at each level of the same hierarchy
+  CHECK(run_a->layout() == run_b->layout());
+  CHECK(event_a->layout() == event_b->layout());
+  CHECK(event_a->layout()->parent() == run_a->layout());
+
+  // Same products, but different level names
+  auto spill = run_a->make_child(2, "spill");
+  spill->add_product("number", 3);
+  spill->add_product("energy", 3.5);
+  CHECK(spill->layout() != event_a->layout());
+
+  // Same products in the store, but different products in its parent
+  auto run_c = product_store::base()->make_child(3, "run");
+  auto event_c = run_c->make_child(1, "event");
+  event_c->add_product("number", 4);
+  event_c->add_product("energy", 4.5);
+  CHECK(event_c->layout() != event_a->layout());
+}
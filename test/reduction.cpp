@@ -29,9 +29,11 @@
 #include "meld/model/product_store.hpp"
 
 #include "catch2/catch_all.hpp"
+#include "oneapi/tbb/task_arena.h"
 #include "spdlog/spdlog.h"
 
 #include <atomic>
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -98,3 +100,177 @@ TEST_CASE("Different levels of reduction", "[graph]")
   CHECK(g.execution_counts("verify_two_layer_job_sum") == 1);
   CHECK(g.execution_counts("verify_job_sum") == 1);
 }
+
+namespace {
+  // A plain (non-atomic) accumulator, which is filled by one thread at a time
+  struct histogram {
+    std::vector<unsigned int> bins = std::vector<unsigned int>(10);
+  };
+
+  void fill(histogram& h, unsigned int number) { ++h.bins[number % 10]; }
+
+  void merge(histogram& result, histogram const& partial)
+  {
+    for (std::size_t i = 0; i != size(result.bins); ++i) {
+      result.bins[i] += partial.bins[i];
+    }
+  }
+}
+
+TEST_CASE("Reduction with per-thread partial results", "[graph]")
+{
+  constexpr auto run_limit = 3u;
+  constexpr auto event_limit = 1000u;
+
+  tbb::task_arena arena{4};
+  arena.execute([&] {
+    framework_graph g{[i = 0u](cached_product_stores& cached_stores) mutable -> product_store_ptr {
+      if (i == 1 + run_limit * (event_limit + 1u)) {
+        return nullptr;
+      }
+      auto const n = i++;
+      if (n == 0u) {
+        return cached_stores.get_store();
+      }
+      auto const run_number = (n - 1) / (event_limit + 1u);
+      auto run_id = level_id::base().make_child(run_number, "run");
+      auto const offset = (n - 1) % (event_limit + 1u);
+      if (offset == 0u) {
+        return cached_stores.get_store(run_id);
+      }
+      auto store = cached_stores.get_store(run_id->make_child(offset - 1, "event"));
+      store->add_product("number", offset - 1);
+      return store;
+    }};
+
+    g.with(fill, concurrency::unlimited)
+      .reduce("number")
+      .for_each("run")
+      .merged_with(merge)
+      .to("run_histogram");
+    g.with(
+       "verify_run_histogram",
+       [](histogram const& h) {
+         CHECK(h.bins == std::vector<unsigned int>(10, event_limit / 10));
+       },
+       concurrency::serial)
+      .monitor("run_histogram");
+    g.execute();
+
+    CHECK(g.execution_counts("fill") == run_limit * event_limit);
+    CHECK(g.execution_counts("verify_run_histogram") == run_limit);
+  });
+}
+
+TEST_CASE("Reduction computed in stages", "[graph]")
+{
+  constexpr auto run_limit = 2u;
+  constexpr auto subrun_limit = 4u;
+  constexpr auto event_limit = 100u;
+  constexpr auto empty_subrun = 2u;
+
+  std::vector<level_id_ptr> ids{level_id::base_ptr()};
+  for (unsigned int r = 0; r != run_limit; ++r) {
+    auto run_id = level_id::base().make_child(r, "run");
+    ids.push_back(run_id);
+    for (unsigned int sr = 0; sr != subrun_limit; ++sr) {
+      auto subrun_id = run_id->make_child(sr, "subrun");
+      ids.push_back(subrun_id);
+      if (sr == empty_subrun) {
+        continue;
+      }
+      for (unsigned int e = 0; e != event_limit; ++e) {
+        ids.push_back(subrun_id->make_child(e, "event"));
+      }
+    }
+  }
+
+  tbb::task_arena arena{4};
+  arena.execute([&] {
+    framework_graph g{[&ids, i = 0ull](cached_product_stores& cached_stores) mutable
+                      -> product_store_ptr {
+      if (i == size(ids)) {
+        return nullptr;
+      }
+      auto const& id = ids[i++];
+      auto store = cached_stores.get_store(id);
+      if (id->level_name() == "event") {
+        store->add_product("number", static_cast<unsigned int>(id->number()));
+      }
+      return store;
+    }};
+
+    g.with(fill, concurrency::unlimited)
+      .reduce("number")
+      .for_each("run")
+      .staged_by("subrun")
+      .merged_with(merge)
+      .to("run_histogram");
+    g.with(
+       "verify_run_histogram",
+       [](histogram const& h) {
+         CHECK(h.bins == std::vector<unsigned int>(10, (subrun_limit - 1) * event_limit / 10));
+       },
+       concurrency::serial)
+      .monitor("run_histogram");
+    g.execute();
+
+    CHECK(g.execution_counts("fill") == run_limit * (subrun_limit - 1) * event_limit);
+    CHECK(g.execution_counts("verify_run_histogram") == run_limit);
+  });
+}
+
+TEST_CASE("Reduction over levels with declared child counts", "[graph]")
+{
+  constexpr auto run_limit = 3u;
+  constexpr auto event_limit = 50u;
+
+  tbb::task_arena arena{4};
+  arena.execute([&] {
+    framework_graph g{[i = 0u](cached_product_stores& cached_stores) mutable -> product_store_ptr {
+      if (i == 1 + run_limit * (event_limit + 1u)) {
+        return nullptr;
+      }
+      auto const n = i++;
+      if (n == 0u) {
+        auto store = cached_stores.get_store();
+        store->declare_child_counts(
+          {{"run", std::size_t{run_limit}}, {"run/event", std::size_t{run_limit * event_limit}}});
+        return store;
+      }
+      auto const run_number = (n - 1) / (event_limit + 1u);
+      auto run_id = level_id::base().make_child(run_number, "run");
+      auto const offset = (n - 1) % (event_limit + 1u);
+      if (offset == 0u) {
+        auto store = cached_stores.get_store(run_id);
+        store->add_product("run_number", run_number);
+        store->declare_child_counts({{"event", std::size_t{event_limit}}});
+        return store;
+      }
+      auto store = cached_stores.get_store(run_id->make_child(offset - 1, "event"));
+      store->add_product("number", offset - 1);
+      return store;
+    }};
+
+    g.with("run_add", add, concurrency::unlimited).reduce("number").for_each("run").to("run_sum");
+    g.with("job_add", add, concurrency::unlimited).reduce("number").to("job_sum");
+
+    // The reduction result must be matched with the products of its interval.
+    g.with(
+       "verify_run_sum",
+       [](unsigned int sum, unsigned int) { CHECK(sum == event_limit * (event_limit - 1) / 2); },
+       concurrency::unlimited)
+      .monitor("run_sum", "run_number");
+    g.with(
+       "verify_job_sum",
+       [](unsigned int sum) { CHECK(sum == run_limit * event_limit * (event_limit - 1) / 2); },
+       concurrency::unlimited)
+      .monitor("job_sum");
+    g.execute();
+
+    CHECK(g.execution_counts("run_add") == run_limit * event_limit);
+    CHECK(g.execution_counts("job_add") == run_limit * event_limit);
+    CHECK(g.execution_counts("verify_run_sum") == run_limit);
+    CHECK(g.execution_counts("verify_job_sum") == 1);
+  });
+}
@@ -0,0 +1,71 @@
+// =======================================================================================
+// This test verifies that the results of a reduction can be created and erased
+// concurrently for millions of reduction intervals, so that the memory used by a
+// reduction is proportional to the number of open intervals.
+// =======================================================================================
+
+#include "meld/core/reduction/results.hpp"
+
+#include "catch2/catch_all.hpp"
+#include "oneapi/tbb/parallel_for.h"
+#include "oneapi/tbb/task_arena.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+
+using namespace meld;
+
+namespace {
+  constexpr std::size_t total_intervals{2'000'000ull};
+  constexpr std::size_t stores_per_interval{3ull};
+
+  struct accumulator {
+    std::atomic<std::size_t> sum{};
+    std::atomic<std::size_t> stores{};
+  };
+}
+
+TEST_CASE("Create and erase reduction results for many intervals", "[reduction]")
+{
+  reduction_results<accumulator> results;
+  std::atomic<std::size_t> committed{};
+  std::atomic<std::size_t> wrong_sums{};
+
+  tbb::task_arena arena{4};
+  arena.execute([&] {
+    tbb::parallel_for(std::size_t{}, total_intervals * stores_per_interval, [&](std::size_t i) {
+      auto const interval = i / stores_per_interval;
+      auto& result =
+        results.get_or_make(interval, [] { return std::make_unique<accumulator>(); });
+      result.sum += i;
+      if (++result.stores != stores_per_interval) {
+        return;
+      }
+
+      // The last store of the interval commits the result.
+      auto committed_result = results.release(interval);
+      auto const first = interval * stores_per_interval;
+      if (not committed_result or committed_result->sum != 3 * first + 3) {
+        ++wrong_sums;
+      }
+      ++committed;
+    });
+  });
+
+  CHECK(committed == total_intervals);
+  CHECK(wrong_sums == 0ull);
+  CHECK(results.size() == 0ull);
+  CHECK(results.release(0ull) == nullptr);
+}
+
+TEST_CASE("Failure to create a reduction result", "[reduction]")
+{
+  reduction_results<accumulator> results;
+  CHECK_THROWS(results.get_or_make(1ull, []() -> std::unique_ptr<accumulator> {
+    throw std::runtime_error("Cannot create result");
+  }));
+  CHECK(results.size() == 0ull);
+  CHECK(results.get_or_make(1ull, [] { return std::make_unique<accumulator>(); }).sum == 0ull);
+}
@@ -1,3 +1,8 @@
+#include "meld/configuration.hpp"
+#include "meld/core/cached_product_stores.hpp"
+#include "meld/core/framework_graph.hpp"
+#include "meld/model/level_id.hpp"
+#include "meld/model/product_store.hpp"
 #include "meld/utilities/thread_counter.hpp"
 
 #include "catch2/catch_all.hpp"
@@ -24,6 +29,65 @@ namespace {
     }
   };
 
+  // Each instance may be used by only one thread at a time.
+  std::atomic<unsigned int> constructed_instances{};
+  std::atomic<unsigned int> observed_numbers{};
+  class thread_unsafe_observer {
+  public:
+    explicit thread_unsafe_observer(unsigned int const factor) : factor_{factor}
+    {
+      ++constructed_instances;
+    }
+
+    unsigned int scale(unsigned int const number)
+    {
+      thread_counter c{counter_};
+      return number * factor_;
+    }
+
+    void observe(unsigned int const number)
+    {
+      thread_counter c{counter_};
+      CHECK(number % factor_ == 0u);
+      ++observed_numbers;
+    }
+
+  private:
+    unsigned int factor_;
+    std::atomic<unsigned int> counter_{};
+  };
+
+  // Counts the copies made of the constructor argument of a replicated object
+  std::atomic<unsigned int> argument_copies{};
+  struct counted_argument {
+    counted_argument() = default;
+    counted_argument(counted_argument const&) { ++argument_copies; }
+    counted_argument(counted_argument&&) = default;
+  };
+
+  struct counted_observer {
+    explicit counted_observer(counted_argument) {}
+    void observe(unsigned int) {}
+  };
+
+  constexpr unsigned int total_events{100u};
+
+  auto make_source()
+  {
+    return [i = 0u](cached_product_stores& cached_stores) mutable -> product_store_ptr {
+      if (i > total_events) {
+        return nullptr;
+      }
+      auto const number = i++;
+      if (number == 0u) {
+        return cached_stores.get_store(level_id::base_ptr());
+      }
+      auto store = cached_stores.get_store(level_id::base().make_child(number, "event"));
+      store->add_product("number", number);
+      return store;
+    };
+  }
+
   template <typename Input>
   using replicated_node_base = tbb::flow::composite_node<std::tuple<Input>, std::tuple<Input>>;
 
@@ -77,3 +141,106 @@ TEST_CASE("Replicated function calls", "[multithreading]")
 
   CHECK(processed_messages == total_messages);
 }
+
+TEST_CASE("Replicated framework nodes", "[multithreading]")
+{
+  constructed_instances = 0u;
+  observed_numbers = 0u;
+
+  framework_graph g{make_source()};
+  g.make<thread_unsafe_observer>(3u)
+    .replicated(4)
+    .with(&thread_unsafe_observer::scale)
+    .transform("number")
+    .to("scaled_number");
+  g.make<thread_unsafe_observer>(3u)
+    .replicated(2)
+    .with(&thread_unsafe_observer::observe)
+    .monitor("scaled_number");
+  g.execute();
+
+  CHECK(constructed_instances == 6u);
+  CHECK(observed_numbers == total_events);
+  CHECK(g.execution_counts("scale") == total_events);
+}
+
+TEST_CASE("Replicas specified by configuration", "[multithreading]")
+{
+  constructed_instances = 0u;
+  observed_numbers = 0u;
+
+  framework_graph g{make_source()};
+  boost::json::object raw_config;
+  raw_config["module_label"] = "replicated_module";
+  raw_config["replicas"] = 3;
+  configuration const config{raw_config};
+
+  auto proxy = g.proxy(config);
+  proxy.make<thread_unsafe_observer>(1u)
+    .with(&thread_unsafe_observer::observe)
+    .monitor("number");
+  g.execute();
+
+  CHECK(constructed_instances == 3u);
+  CHECK(observed_numbers == total_events);
+}
+
+TEST_CASE("Invalid number of replicas", "[multithreading]")
+{
+  framework_graph g{make_source()};
+  g.make<thread_unsafe_observer>(1u)
+    .replicated(0)
+    .with(&thread_unsafe_observer::observe)
+    .monitor("number");
+  CHECK_THROWS(g.execute());
+}
+
+TEST_CASE("Replicated nodes with unlimited concurrency", "[multithreading]")
+{
+  constructed_instances = 0u;
+  observed_numbers = 0u;
+
+  // The concurrency is reduced to the number of replicas.
+  framework_graph g{make_source()};
+  g.make<thread_unsafe_observer>(1u)
+    .replicated(3)
+    .with(&thread_unsafe_observer::observe, concurrency::unlimited)
+    .monitor("number");
+  g.execute();
+
+  CHECK(constructed_instances == 3u);
+  CHECK(observed_numbers == total_events);
+}
+
+TEST_CASE("Constructor arguments are copied only for replicas", "[multithreading]")
+{
+  argument_copies = 0u;
+  {
+    framework_graph g{make_source()};
+    g.make<counted_observer>(counted_argument{})
+      .with(&counted_observer::observe)
+      .monitor("number");
+    g.execute();
+  }
+  CHECK(argument_copies == 0u);
+
+  {
+    framework_graph g{make_source()};
+    g.make<counted_observer>(counted_argument{})
+      .replicated(3)
+      .with(&counted_observer::observe)
+      .monitor("number");
+    g.execute();
+  }
+  // The last replica is constructed from the argument itself.
+  CHECK(argument_copies == 2u);
+}
+
+TEST_CASE("Replicating an object after registering its functions", "[multithreading]")
+{
+  framework_graph g{make_source()};
+  auto module = g.make<thread_unsafe_observer>(1u);
+  module.with(&thread_unsafe_observer::observe).monitor("number");
+  module.replicated(2);
+  CHECK_THROWS(g.execute());
+}
@@ -0,0 +1,132 @@
+// =======================================================================================
+// This test verifies that nodes using the same named resource do not execute
+// concurrently, and that a resource declared with N tokens is used by at most N nodes at
+// a time.  The graphs are executed in an arena with several slots so that nodes can
+// execute concurrently even on machines with few cores.
+// =======================================================================================
+
+#include "meld/core/cached_product_stores.hpp"
+#include "meld/core/framework_graph.hpp"
+#include "meld/model/level_id.hpp"
+#include "meld/model/product_store.hpp"
+#include "meld/utilities/thread_counter.hpp"
+
+#include "catch2/catch_all.hpp"
+#include "oneapi/tbb/task_arena.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace meld;
+using namespace std::chrono_literals;
+
+namespace {
+  constexpr unsigned int total_events{20u};
+  constexpr int max_parallelism{4};
+
+  auto make_source()
+  {
+    return [i = 0u](cached_product_stores& cached_stores) mutable -> product_store_ptr {
+      if (i > total_events) {
+        return nullptr;
+      }
+      auto const number = i++;
+      if (number == 0u) {
+        return cached_stores.get_store(level_id::base_ptr());
+      }
+      auto store = cached_stores.get_store(level_id::base().make_child(number, "event"));
+      store->add_product("number", number);
+      return store;
+    };
+  }
+
+  struct db_writer {
+    std::atomic<unsigned int>& users;
+    std::atomic<unsigned int>& outputs;
+    void save(product_store const& store)
+    {
+      thread_counter c{users, 2};
+      if (store.id()->level_name() == "event") {
+        ++outputs;
+      }
+    }
+  };
+
+  auto use(std::atomic<unsigned int>& counter, unsigned int const max_users = 1)
+  {
+    return [&counter, max_users](unsigned int) {
+      thread_counter c{counter, max_users};
+      std::this_thread::sleep_for(100us);
+    };
+  }
+}
+
+TEST_CASE("Nodes sharing a resource", "[graph]")
+{
+  std::atomic<unsigned int> root_users{};
+  std::atomic<unsigned int> genie_users{};
+
+  tbb::task_arena arena{max_parallelism};
+  arena.execute([&] {
+    framework_graph g{make_source(), max_parallelism};
+    g.with("root_1", use(root_users), concurrency::unlimited)
+      .using_resources("ROOT")
+      .monitor("number");
+    g.with("root_2", use(root_users), concurrency::unlimited)
+      .using_resources("ROOT")
+      .monitor("number");
+    g.with(
+       "root_and_genie",
+       [&](unsigned int) {
+         thread_counter root{root_users};
+         thread_counter genie{genie_users};
+       },
+       concurrency::unlimited)
+      .using_resources("GENIE", "ROOT")
+      .monitor("number");
+    g.with("genie", use(genie_users), concurrency::unlimited)
+      .using_resources("GENIE")
+      .monitor("number");
+    g.with("unrestricted", [](unsigned int) {}, concurrency::unlimited).monitor("number");
+    g.execute();
+
+    CHECK(g.execution_counts("root_1") == total_events);
+    CHECK(g.execution_counts("root_2") == total_events);
+    CHECK(g.execution_counts("root_and_genie") == total_events);
+    CHECK(g.execution_counts("genie") == total_events);
+    CHECK(g.execution_counts("unrestricted") == total_events);
+  });
+}
+
+TEST_CASE("Nodes sharing a counted resource", "[graph]")
+{
+  std::atomic<unsigned int> db_users{};
+  std::atomic<unsigned int> outputs{};
+
+  tbb::task_arena arena{max_parallelism};
+  arena.execute([&] {
+    framework_graph g{make_source(), max_parallelism};
+    g.declare_resource("db_connections", 2);
+    for (auto const* name : {"reader_1", "reader_2", "reader_3"}) {
+      g.with(name, use(db_users, 2), concurrency::unlimited)
+        .using_resources("db_connections")
+        .monitor("number");
+    }
+    g.make<db_writer>(db_users, outputs)
+      .output_with(&db_writer::save, concurrency::unlimited)
+      .using_resources("db_connections");
+    g.execute();
+
+    CHECK(g.execution_counts("reader_1") == total_events);
+    CHECK(g.execution_counts("reader_2") == total_events);
+    CHECK(g.execution_counts("reader_3") == total_events);
+    CHECK(outputs == total_events);
+  });
+}
+
+TEST_CASE("Resources must have tokens", "[graph]")
+{
+  framework_graph g{make_source()};
+  CHECK_THROWS(g.declare_resource("db_connections", 0));
+}
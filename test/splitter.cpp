@@ -18,11 +18,15 @@
 #include "meld/core/framework_graph.hpp"
 #include "meld/model/level_id.hpp"
 #include "meld/model/product_store.hpp"
+#include "meld/model/product_view.hpp"
+#include "meld/utilities/sequence.hpp"
 #include "test/products_for_output.hpp"
 
 #include "catch2/catch_all.hpp"
+#include "oneapi/tbb/task_arena.h"
 
 #include <atomic>
+#include <numeric>
 #include <string>
 #include <vector>
 
@@ -61,6 +65,75 @@ namespace {
     numbers_t::const_iterator end_;
   };
 
+  // The children of each parent can be created independently of each other.
+  class slices {
+  public:
+    explicit slices(unsigned int num_slices) : size_{num_slices} {}
+    std::size_t size() const { return size_; }
+    unsigned int element(std::size_t i) const { return static_cast<unsigned int>(i); }
+
+  private:
+    unsigned int size_;
+  };
+
+  // Children are yielded lazily; the number of children that have been yielded but not yet
+  // seen by the 'count_seen' monitor is recorded.
+  std::atomic<unsigned int> yielded{};
+  std::atomic<unsigned int> seen{};
+  std::atomic<unsigned int> max_unseen{};
+
+  class lazy_iota {
+  public:
+    explicit lazy_iota(unsigned int max_number) : max_{max_number} {}
+    sequence<unsigned int> children() const
+    {
+      for (unsigned int i = 0; i != max_; ++i) {
+        auto const unseen = yielded++ - seen;
+        for (auto current = max_unseen.load(); unseen > current;) {
+          max_unseen.compare_exchange_weak(current, unseen);
+        }
+        co_yield i;
+      }
+    }
+
+  private:
+    unsigned int max_;
+  };
+
+  // Each child refers to a slice of the parent's waveform
+  constexpr std::size_t slice_size{10};
+
+  class waveform_slicer {
+  public:
+    explicit waveform_slicer(numbers_t const& waveform) : waveform_{waveform} {}
+    std::size_t size() const { return waveform_.size() / slice_size; }
+    product_view<unsigned int> element(std::size_t i) const
+    {
+      return waveform_.subspan(i * slice_size, slice_size);
+    }
+
+  private:
+    product_view<unsigned int> waveform_;
+  };
+
+  unsigned int sum_slice(product_view<unsigned int> slice)
+  {
+    return std::accumulate(slice.begin(), slice.end(), 0u);
+  }
+
+  struct check_waveforms {
+    std::atomic<unsigned int>& released;
+    void save(product_store const& store)
+    {
+      if (store.level_name() != "slice") {
+        return;
+      }
+      if (store.parent("event")->get_product<numbers_t>("waveform").empty()) {
+        ++released;
+      }
+    }
+  };
+
   void add(std::atomic<unsigned int>& counter, unsigned number) { counter += number; }
   void add_numbers(std::atomic<unsigned int>& counter, unsigned number) { counter += number; }
 
@@ -135,3 +208,146 @@ TEST_CASE("Splitting the processing", "[graph]")
   CHECK(g.execution_counts("add_numbers") == 20);
   CHECK(g.execution_counts("check_sum_same") == index_limit);
 }
+
+TEST_CASE("Splitting the processing in parallel chunks", "[graph]")
+{
+  constexpr auto index_limit = 2u;
+  constexpr auto slice_limit = 5000u;
+
+  std::atomic<unsigned int> misnumbered{};
+  tbb::task_arena arena{4};
+  arena.execute([&] {
+    framework_graph g{[i = 0u](cached_product_stores& cached_stores) mutable -> product_store_ptr {
+      if (i > index_limit) {
+        return nullptr;
+      }
+      auto const n = i++;
+      if (n == 0u) {
+        return cached_stores.get_store();
+      }
+      auto store = cached_stores.get_store(level_id::base().make_child(n - 1, "event"));
+      store->add_product<unsigned>("num_slices", slice_limit * n);
+      return store;
+    }};
+
+    g.with<slices>(&slices::size, &slices::element, concurrency::unlimited)
+      .split("num_slices")
+      .into("slice_number")
+      .within_family("slice");
+    g.with(
+       "check_numbering",
+       [&misnumbered](handle<unsigned int> const number) {
+         if (number.level_id().number() != *number) {
+           ++misnumbered;
+         }
+       },
+       concurrency::unlimited)
+      .monitor("slice_number");
+    g.with(add, concurrency::unlimited).reduce("slice_number").for_each("event").to("sum");
+    g.with(
+       "check_sum",
+       [](handle<unsigned int> const sum) {
+         auto const n = slice_limit * (sum.level_id().number() + 1);
+         CHECK(*sum == n * (n - 1) / 2);
+       },
+       concurrency::unlimited)
+      .monitor("sum");
+    g.execute();
+
+    CHECK(g.execution_counts("slices") == index_limit);
+    CHECK(g.execution_counts("check_numbering") == 3 * slice_limit);
+    CHECK(g.execution_counts("check_sum") == index_limit);
+  });
+  CHECK(misnumbered == 0u);
+}
+
+TEST_CASE("Lazy splitting with a bounded number of outstanding children", "[graph]")
+{
+  constexpr auto index_limit = 2u;
+  constexpr auto number_limit = 1000u;
+  constexpr auto outstanding_limit = 10u;
+
+  tbb::task_arena arena{4};
+  arena.execute([&] {
+    framework_graph g{[i = 0u](cached_product_stores& cached_stores) mutable -> product_store_ptr {
+      if (i > index_limit) {
+        return nullptr;
+      }
+      auto const n = i++;
+      if (n == 0u) {
+        return cached_stores.get_store();
+      }
+      auto store = cached_stores.get_store(level_id::base().make_child(n - 1, "event"));
+      store->add_product<unsigned>("max_number", unsigned{number_limit});
+      return store;
+    }};
+
+    g.with<lazy_iota>(&lazy_iota::children, concurrency::unlimited)
+      .split("max_number")
+      .into("new_number")
+      .within_family("lower")
+      .max_outstanding(outstanding_limit);
+    g.with("count_seen", [](unsigned int) { ++seen; }, concurrency::unlimited)
+      .monitor("new_number");
+    g.with(add, concurrency::unlimited).reduce("new_number").for_each("event").to("sum");
+    g.with(
+       "check_sum",
+       [](unsigned int const sum) { CHECK(sum == number_limit * (number_limit - 1) / 2); },
+       concurrency::unlimited)
+      .monitor("sum");
+    g.execute();
+
+    CHECK(g.execution_counts("lazy_iota") == index_limit);
+    CHECK(g.execution_counts("count_seen") == index_limit * number_limit);
+    CHECK(g.execution_counts("check_sum") == index_limit);
+  });
+  CHECK(yielded == index_limit * number_limit);
+  // Each of the two parents has at most 'outstanding_limit' outstanding children.
+  CHECK(max_unseen <= index_limit * outstanding_limit);
+}
+
+TEST_CASE("Splitting into views of the parent product", "[graph]")
+{
+  constexpr auto index_limit = 2u;
+  constexpr auto waveform_size = 1000u;
+
+  std::atomic<unsigned int> released{};
+  tbb::task_arena arena{4};
+  arena.execute([&] {
+    framework_graph g{[i = 0u](cached_product_stores& cached_stores) mutable -> product_store_ptr {
+      if (i > index_limit) {
+        return nullptr;
+      }
+      auto const n = i++;
+      if (n == 0u) {
+        return cached_stores.get_store();
+      }
+      auto store = cached_stores.get_store(level_id::base().make_child(n - 1, "event"));
+      numbers_t waveform(waveform_size);
+      std::iota(waveform.begin(), waveform.end(), 0u);
+      store->add_product("waveform", std::move(waveform));
+      return store;
+    }};
+
+    g.with<waveform_slicer>(
+       &waveform_slicer::size, &waveform_slicer::element, concurrency::unlimited)
+      .split("waveform")
+      .into("slice")
+      .within_family("slice");
+    g.with(sum_slice, concurrency::unlimited).transform("slice").to("slice_sum");
+    g.with(add, concurrency::unlimited).reduce("slice_sum").for_each("event").to("sum");
+    g.with(
+       "check_sum",
+       [](unsigned int const sum) { CHECK(sum == waveform_size * (waveform_size - 1) / 2); },
+       concurrency::unlimited)
+      .monitor("sum");
+    g.make<check_waveforms>(released).output_with(&check_waveforms::save,
+                                                  concurrency::unlimited);
+    g.execute();
+
+    CHECK(g.execution_counts("sum_slice") == index_limit * waveform_size / slice_size);
+    CHECK(g.execution_counts("check_sum") == index_limit);
+  });
+  // The waveforms viewed by the slices are not released while the slices are processed.
+  CHECK(released == 0u);
+}
@@ -0,0 +1,177 @@
+// =======================================================================================
+// This test verifies that linear chains of transforms are fused when the graph is
+// finalized:
+//
+//    Multiplexer
+//         |
+//         A
+//         |
+//         B
+//         |
+//         C
+//
+// B is the only consumer of A's product, and C is the only consumer of B's product.
+// Because B and C have unlimited concurrency, they are invoked directly from the body of
+// their producers, on the same thread and immediately after the producer's user function.
+// The fused transforms are still reported as separate nodes, and their products are
+// still seen by the output nodes.
+// =======================================================================================
+
+#include "meld/core/cached_product_stores.hpp"
+#include "meld/core/framework_graph.hpp"
+#include "meld/model/level_id.hpp"
+#include "meld/model/product_store.hpp"
+
+#include "catch2/catch_all.hpp"
+#include "oneapi/tbb/task_arena.h"
+
+#include <atomic>
+#include <string>
+
+using namespace meld;
+
+namespace {
+  constexpr unsigned int total_events{20u};
+  constexpr int max_parallelism{4};
+
+  thread_local unsigned int last_number{-1u};
+
+  auto make_source()
+  {
+    return [i = 0u](cached_product_stores& cached_stores) mutable -> product_store_ptr {
+      if (i > total_events) {
+        return nullptr;
+      }
+      auto const number = i++;
+      if (number == 0u) {
+        return cached_stores.get_store(level_id::base_ptr());
+      }
+      auto store = cached_stores.get_store(level_id::base().make_child(number, "event"));
+      store->add_product("number", number);
+      return store;
+    };
+  }
+
+  unsigned int remember(unsigned int const number)
+  {
+    last_number = number;
+    return number;
+  }
+
+  auto check_same_thread(std::atomic<unsigned int>& mismatches)
+  {
+    return [&mismatches](unsigned int const number) {
+      if (number != last_number) {
+        ++mismatches;
+      }
+      return number;
+    };
+  }
+
+  struct event_counter {
+    std::atomic<unsigned int>& stores;
+    void save(product_store const& store)
+    {
+      if (store.id()->level_name() == "event") {
+        ++stores;
+      }
+    }
+  };
+}
+
+TEST_CASE("Fused chain of transforms", "[graph]")
+{
+  std::atomic<unsigned int> mismatches{};
+  std::atomic<unsigned int> saved_stores{};
+  std::atomic<unsigned int> sum{};
+
+  tbb::task_arena arena{max_parallelism};
+  arena.execute([&] {
+    framework_graph g{make_source(), max_parallelism};
+    g.with("A", remember, concurrency::unlimited).transform("number").to("a");
+    g.with("B", check_same_thread(mismatches), concurrency::unlimited).transform("a").to("b");
+    g.with("C", check_same_thread(mismatches), concurrency::unlimited).transform("b").to("c");
+    g.with("sum", [&sum](unsigned int const c) { sum += c; }, concurrency::unlimited)
+      .monitor("c");
+    g.make<event_counter>(saved_stores).output_with(&event_counter::save, concurrency::unlimited);
+    g.execute("transform_chains_t");
+
+    CHECK(g.execution_counts("A") == total_events);
+    CHECK(g.execution_counts("B") == total_events);
+    CHECK(g.execution_counts("C") == total_events);
+    CHECK(g.execution_counts("sum") == total_events);
+  });
+
+  CHECK(mismatches == 0u);
+  CHECK(sum == total_events * (total_events + 1) / 2);
+  // The source store and the continuations created by A, B, and C for each event
+  CHECK(saved_stores == 4 * total_events);
+}
+
+TEST_CASE("Transforms that cannot be fused", "[graph]")
+{
+  std::atomic<unsigned int> b_sum{};
+  std::atomic<unsigned int> c_sum{};
+  std::atomic<unsigned int> e_sum{};
+
+  tbb::task_arena arena{max_parallelism};
+  arena.execute([&] {
+    framework_graph g{make_source(), max_parallelism};
+    // A's product has two consumers
+    g.with("A", remember, concurrency::unlimited).transform("number").to("a");
+    g.with("B", [](unsigned int a) { return a; }, concurrency::unlimited).transform("a").to("b");
+    g.with("C", [](unsigned int a) { return 2 * a; }, concurrency::unlimited)
+      .transform("a")
+      .to("c");
+    // D has limited concurrency, so E cannot be run within D's body
+    g.with("D", [](unsigned int b) { return 3 * b; }, concurrency::serial).transform("b").to("d");
+    g.with("E", [](unsigned int d) { return d + 1; }, concurrency::unlimited)
+      .transform("d")
+      .to("e");
+
+    g.with("b_sum", [&b_sum](unsigned int const b) { b_sum += b; }, concurrency::unlimited)
+      .monitor("b");
+    g.with("c_sum", [&c_sum](unsigned int const c) { c_sum += c; }, concurrency::unlimited)
+      .monitor("c");
+    g.with("e_sum", [&e_sum](unsigned int const e) { e_sum += e; }, concurrency::unlimited)
+      .monitor("e");
+    g.execute();
+
+    CHECK(g.execution_counts("B") == total_events);
+    CHECK(g.execution_counts("C") == total_events);
+    CHECK(g.execution_counts("D") == total_events);
+    CHECK(g.execution_counts("E") == total_events);
+  });
+
+  constexpr unsigned int expected{total_events * (total_events + 1) / 2};
+  CHECK(b_sum == expected);
+  CHECK(c_sum == 2 * expected);
+  CHECK(e_sum == 3 * expected + total_events);
+}
+
+TEST_CASE("Long fused chain of transforms", "[graph]")
+{
+  constexpr unsigned int chain_length{200u};
+  std::atomic<unsigned int> mismatches{};
+  std::atomic<unsigned int> sum{};
+
+  tbb::task_arena arena{max_parallelism};
+  arena.execute([&] {
+    framework_graph g{make_source(), max_parallelism};
+    g.with("t0", remember, concurrency::unlimited).transform("number").to("p0");
+    for (unsigned int i = 1; i != chain_length; ++i) {
+      auto const n = std::to_string(i);
+      g.with("t" + n, check_same_thread(mismatches), concurrency::unlimited)
+        .transform("p" + std::to_string(i - 1))
+        .to("p" + n);
+    }
+    g.with("sum", [&sum](unsigned int const p) { sum += p; }, concurrency::unlimited)
+      .monitor("p" + std::to_string(chain_length - 1));
+    g.execute();
+
+    CHECK(g.execution_counts("t" + std::to_string(chain_length - 1)) == total_events);
+  });
+
+  CHECK(mismatches == 0u);
+  CHECK(sum == total_events * (total_events + 1) / 2);
+}
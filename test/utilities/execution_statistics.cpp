@@ -0,0 +1,88 @@
+#include "meld/utilities/execution_statistics.hpp"
+#include "meld/utilities/sleep_for.hpp"
+
+#include "catch2/catch_all.hpp"
+#include "oneapi/tbb/parallel_for.h"
+
+#include <chrono>
+
+using namespace meld;
+using namespace std::chrono;
+
+namespace {
+  struct timing_enabled {
+    timing_enabled() { enable_execution_statistics(); }
+    ~timing_enabled() { enable_execution_statistics(false); }
+  };
+}
+
+TEST_CASE("No recorded executions", "[utilities]")
+{
+  execution_statistics stats;
+  auto const summary = stats.summary();
+  CHECK(summary.count == 0ull);
+  CHECK(summary.total_wall == 0ns);
+  CHECK(summary.max_wall == 0ns);
+}
+
+TEST_CASE("Recorded executions", "[utilities]")
+{
+  execution_statistics stats;
+  for (int i = 1; i <= 100; ++i) {
+    stats.record(microseconds{i}, microseconds{i / 2});
+  }
+  auto const summary = stats.summary();
+  CHECK(summary.count == 100ull);
+  CHECK(summary.total_wall == 5050us);
+  CHECK(summary.total_cpu == 2500us);
+  CHECK(summary.min_wall == 1us);
+  CHECK(summary.max_wall == 100us);
+
+  // Percentiles are accurate to within the width of a histogram bin (25% of the value).
+  CHECK(summary.p50_wall >= 50us);
+  CHECK(summary.p50_wall <= 50us * 1.25);
+  CHECK(summary.p99_wall >= 99us);
+  CHECK(summary.p99_wall <= 100us);
+}
+
+TEST_CASE("Executions recorded on several threads", "[utilities]")
+{
+  execution_statistics stats;
+  tbb::parallel_for(1, 1001, [&stats](int const i) { stats.record(microseconds{i}, 0us); });
+  auto const summary = stats.summary();
+  CHECK(summary.count == 1000ull);
+  CHECK(summary.total_wall == 500500us);
+  CHECK(summary.min_wall == 1us);
+  CHECK(summary.max_wall == 1000us);
+}
+
+TEST_CASE("Timing is disabled by default", "[utilities]")
+{
+  REQUIRE_FALSE(execution_statistics_enabled());
+  execution_statistics stats;
+  {
+    auto const sentry = stats.time();
+  }
+  CHECK(stats.summary().count == 0ull);
+}
+
+TEST_CASE("Timed executions", "[utilities]")
+{
+  timing_enabled const enabled;
+  execution_statistics stats;
+  {
+    auto const sentry = stats.time();
+    spin_for(10ms);
+  }
+  {
+    auto const sentry = stats.time();
+    sleep_for(10ms);
+  }
+  auto const summary = stats.summary();
+  CHECK(summary.count == 2ull);
+  CHECK(summary.min_wall >= 10ms);
+  CHECK(summary.total_wall >= 20ms);
+  // The CPU time of the spinning thread depends on the load of the machine.
+  CHECK(summary.total_cpu > 0ns);
+  CHECK(summary.total_cpu < summary.total_wall);
+}
@@ -0,0 +1,66 @@
+#include "meld/utilities/tracer.hpp"
+
+#include "catch2/catch_all.hpp"
+#include "oneapi/tbb/parallel_for.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace meld;
+
+namespace {
+  std::size_t occurrences(std::string const& text, std::string const& pattern)
+  {
+    std::size_t result{};
+    for (auto pos = text.find(pattern); pos != std::string::npos;
+         pos = text.find(pattern, pos + size(pattern))) {
+      ++result;
+    }
+    return result;
+  }
+}
+
+TEST_CASE("Names are registered once", "[utilities]")
+{
+  auto const a = trace::register_name("a");
+  auto const b = trace::register_name("b");
+  CHECK(a != b);
+  CHECK(trace::register_name("a") == a);
+}
+
+TEST_CASE("Write Chrome trace", "[utilities]")
+{
+  auto const before = trace::register_name("before_enabling");
+  auto const work = trace::register_name("work \"quoted\"");
+  auto const controlled = trace::register_name("line\nbreak\ttab\x01");
+  {
+    trace::scope const s{trace::category::node, before};
+  }
+
+  trace::enable();
+  tbb::parallel_for(0, 100, [work](int) { trace::scope const s{trace::category::node, work}; });
+  {
+    trace::scope const s{trace::category::node, controlled};
+  }
+
+  auto const filename = std::filesystem::temp_directory_path() / "meld_tracer_test.json";
+  trace::write_chrome_trace(filename.string());
+
+  std::ifstream in{filename};
+  std::stringstream contents;
+  contents << in.rdbuf();
+  std::filesystem::remove(filename);
+
+  auto const text = contents.str();
+  CHECK(text.starts_with("{\"traceEvents\":["));
+  CHECK(occurrences(text, "before_enabling") == 0ull);
+  CHECK(occurrences(text, R"("name":"work \"quoted\"","cat":"node","ph":"X")") == 100ull);
+  CHECK(occurrences(text, R"("name":"line\nbreak\ttab\u0001")") == 1ull);
+}
+
+TEST_CASE("Unwritable trace file", "[utilities]")
+{
+  CHECK_THROWS(trace::write_chrome_trace("/nonexistent-directory/trace.json"));
+}